@@ -0,0 +1,212 @@
+#include "FramePool.hpp"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+size_t roundUp(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+void* alignedAlloc(size_t bytes, size_t alignment) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, alignment);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, bytes) == 0 ? p : nullptr;
+#endif
+}
+
+void alignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+FramePool* g_installed = nullptr;
+
+}
+
+FramePool::FramePool(HugePageMode hugePages, size_t maxCachedBytes)
+    : m_hugePages(hugePages), m_maxCachedBytes(maxCachedBytes) {
+#if !defined(__linux__)
+    m_hugePages = HUGE_PAGES_OFF;
+#endif
+}
+
+FramePool::~FramePool() {
+    trim();
+}
+
+FramePool* FramePool::install(HugePageMode hugePages) {
+    if (!g_installed) {
+        // deliberately leaked, see the class comment
+        g_installed = new FramePool(hugePages);
+        cv::Mat::setDefaultAllocator(g_installed);
+    }
+    return g_installed;
+}
+
+FramePool* FramePool::installed() {
+    return g_installed;
+}
+
+size_t FramePool::sizeClass(size_t bytes) {
+    if (bytes <= 4096) return roundUp(bytes ? bytes : 1, kAlignment);
+    // four classes per power of two: pow2 < bytes <= 2 * pow2 rounds up to a quarter of pow2
+    size_t pow2 = 4096;
+    while (pow2 * 2 < bytes) pow2 *= 2;
+    return roundUp(bytes, pow2 / 4);
+}
+
+const char* FramePool::hugePageModeName(HugePageMode mode) {
+    switch (mode) {
+        case HUGE_PAGES_TRANSPARENT: return "thp";
+        case HUGE_PAGES_EXPLICIT: return "explicit";
+        default: return "off";
+    }
+}
+
+void* FramePool::systemAlloc(size_t cls) const {
+#ifdef __linux__
+    if (m_hugePages != HUGE_PAGES_OFF && cls >= kHugePageSize) {
+        const size_t length = roundUp(cls, kHugePageSize);
+#ifdef MAP_HUGETLB
+        if (m_hugePages == HUGE_PAGES_EXPLICIT) {
+            void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (p != MAP_FAILED) {
+                m_hugetlb.insert(p);
+                ++m_stats.hugePageBuffers;
+                return p;
+            }
+            ++m_stats.hugePageFallbacks;
+        }
+#endif
+        // transparent huge pages need a 2 MB aligned range to map it with whole huge pages
+        void* p = alignedAlloc(length, kHugePageSize);
+#ifdef MADV_HUGEPAGE
+        if (p && madvise(p, length, MADV_HUGEPAGE) == 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.hugePageBuffers;
+        }
+#endif
+        return p;
+    }
+#endif
+    return alignedAlloc(cls, kAlignment);
+}
+
+void FramePool::systemFree(void* p, size_t cls) const {
+#ifdef __linux__
+    std::set<void*>::iterator it = m_hugetlb.find(p);
+    if (it != m_hugetlb.end()) {
+        m_hugetlb.erase(it);
+        munmap(p, roundUp(cls, kHugePageSize));
+        ++m_stats.systemFrees;
+        return;
+    }
+#else
+    (void)cls;
+#endif
+    alignedFree(p);
+    ++m_stats.systemFrees;
+}
+
+void* FramePool::acquire(size_t bytes) const {
+    const size_t cls = sizeClass(bytes);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.allocations;
+        m_stats.bytesInUse += cls;
+        std::map<size_t, std::vector<void*>>::iterator it = m_free.find(cls);
+        if (it != m_free.end() && !it->second.empty()) {
+            void* p = it->second.back();
+            it->second.pop_back();
+            m_stats.bytesCached -= cls;
+            ++m_stats.recycled;
+            return p;
+        }
+        ++m_stats.systemAllocations;
+    }
+    // new memory is requested outside the lock
+    void* p = systemAlloc(cls);
+    if (!p) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_stats.allocations;
+        --m_stats.systemAllocations;
+        m_stats.bytesInUse -= cls;
+        CV_Error(cv::Error::StsNoMem, "FramePool: out of memory");
+    }
+    return p;
+}
+
+void FramePool::release(void* p, size_t cls) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.bytesInUse -= cls;
+    if (m_stats.bytesCached + cls > m_maxCachedBytes) {
+        systemFree(p, cls);
+        return;
+    }
+    m_free[cls].push_back(p);
+    m_stats.bytesCached += cls;
+}
+
+void FramePool::trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::map<size_t, std::vector<void*>>::iterator it = m_free.begin(); it != m_free.end(); ++it) {
+        for (void* p : it->second) systemFree(p, it->first);
+    }
+    m_free.clear();
+    m_stats.bytesCached = 0;
+}
+
+FramePoolStats FramePool::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+// Same layout as OpenCV's own allocator: steps computed from the innermost dimension out, unless
+// the caller wraps its own data
+cv::UMatData* FramePool::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                  FramePoolAccessFlag, cv::UMatUsageFlags) const {
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; --i) {
+        if (step) {
+            if (data && step[i] != CV_AUTOSTEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data ? (uchar*)data : (uchar*)acquire(total);
+    u->size = total;
+    if (data) u->flags |= cv::UMatData::USER_ALLOCATED;
+    return u;
+}
+
+bool FramePool::allocate(cv::UMatData* u, FramePoolAccessFlag, cv::UMatUsageFlags) const {
+    return u != nullptr;
+}
+
+void FramePool::deallocate(cv::UMatData* u) const {
+    if (!u) return;
+    CV_Assert(u->urefcount == 0 && u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        release(u->origdata, sizeClass(u->size));
+        u->origdata = nullptr;
+    }
+    delete u;
+}
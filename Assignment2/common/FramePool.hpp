@@ -0,0 +1,126 @@
+/*
+ * FramePool.hpp
+ *
+ *  cv::MatAllocator that recycles 64-byte-aligned buffers by size class, optionally on huge pages.
+ *
+ */
+#ifndef FRAMEPOOL_HPP
+#define FRAMEPOOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// MatAllocator takes its access flags as an enum since OpenCV 4.1
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 1)
+typedef cv::AccessFlag FramePoolAccessFlag;
+#else
+typedef int FramePoolAccessFlag;
+#endif
+
+//! HugePageMode
+/*! What backs buffers of at least a huge page (2 MB). Explicit pages come from the hugetlbfs pool
+    (vm.nr_hugepages) and fall back to transparent ones when it is empty. Linux only, other
+    systems always use normal pages. */
+enum HugePageMode { HUGE_PAGES_OFF = 0, HUGE_PAGES_TRANSPARENT = 1, HUGE_PAGES_EXPLICIT = 2 };
+
+//! FramePoolStats
+/*! Snapshot of the pool counters. Subtract two snapshots to get per-run numbers. */
+struct FramePoolStats {
+    uint64_t allocations = 0;       //!< Mat buffers handed out
+    uint64_t recycled = 0;          //!< of those, taken from a free list
+    uint64_t systemAllocations = 0; //!< of those, new memory from the OS: 0 per frame in steady state
+    uint64_t systemFrees = 0;       //!< buffers returned to the OS (cache full or trim)
+    uint64_t hugePageBuffers = 0;   //!< system allocations on huge pages (hugetlbfs or advised THP)
+    uint64_t hugePageFallbacks = 0; //!< explicit huge page allocations that found the pool empty
+    size_t bytesInUse = 0;          //!< held by live Mats, by size class
+    size_t bytesCached = 0;         //!< on the free lists
+
+    FramePoolStats operator-(const FramePoolStats& other) const {
+        FramePoolStats d = *this;
+        d.allocations -= other.allocations;
+        d.recycled -= other.recycled;
+        d.systemAllocations -= other.systemAllocations;
+        d.systemFrees -= other.systemFrees;
+        d.hugePageBuffers -= other.hugePageBuffers;
+        d.hugePageFallbacks -= other.hugePageFallbacks;
+        return d;
+    }
+};
+
+//!  FramePool.
+/*!
+ Mat allocator for the processing pipeline. A released buffer goes onto the free list of its size
+ class and the next Mat of that class takes it back, so the per-frame Mats (filter output, warp
+ target, BGR conversions, clones) stop hitting malloc/free and the page faults of fresh memory once
+ every class has been seen. Classes are multiples of 64 bytes up to 4 KB, then four per power of two,
+ so at most a quarter of a buffer is unused. Every buffer is 64-byte aligned. Cached memory is
+ capped; a buffer released beyond the cap goes back to the OS.
+
+ install() makes a process-wide pool cv::Mat's default allocator. Mats remember their allocator,
+ so the installed pool is never destroyed: Mats still alive at exit can release into it. Thread-safe.
+ */
+class FramePool : public cv::MatAllocator {
+public:
+    static const size_t kAlignment = 64;
+    static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+    explicit FramePool(HugePageMode hugePages = HUGE_PAGES_OFF, size_t maxCachedBytes = 512u * 1024 * 1024);
+    ~FramePool();
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    //! install
+    /*! Creates the process-wide pool and sets it as cv::Mat's default allocator. Call once, before
+        other threads create Mats. Returns the pool. */
+    static FramePool* install(HugePageMode hugePages);
+    //! installed
+    /*! The pool install() created, nullptr if none. */
+    static FramePool* installed();
+
+    //! sizeClass
+    /*! Bytes actually reserved for a buffer of the given size. */
+    static size_t sizeClass(size_t bytes);
+    static const char* hugePageModeName(HugePageMode mode);
+
+    //! trim
+    /*! Returns every cached buffer to the OS, e.g. after a resolution change. */
+    void trim();
+
+    FramePoolStats stats() const;
+    HugePageMode hugePages() const { return m_hugePages; }
+
+    // cv::MatAllocator
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           FramePoolAccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, FramePoolAccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    //! acquire
+    /*! A buffer of sizeClass(bytes): recycled, or new from the OS. */
+    void* acquire(size_t bytes) const;
+    //! release
+    /*! Puts a buffer of the given class back on its free list, or frees it when the cache is full. */
+    void release(void* p, size_t cls) const;
+    //! systemAlloc
+    /*! New memory for a class, on huge pages when the mode asks for them and the class is big enough. */
+    void* systemAlloc(size_t cls) const;
+    //! systemFree
+    /*! Returns a buffer from systemAlloc to the OS. Caller holds m_mutex. */
+    void systemFree(void* p, size_t cls) const;
+
+    HugePageMode m_hugePages;
+    size_t m_maxCachedBytes;
+    mutable std::mutex m_mutex;
+    mutable std::map<size_t, std::vector<void*>> m_free;    //!< free lists by size class
+    mutable std::set<void*> m_hugetlb;                       //!< buffers mapped from hugetlbfs
+    mutable FramePoolStats m_stats;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_file(nullptr), m_mapping(nullptr) {}
+
+bool MappedFile::open(const std::string& path, bool copyOnWrite) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = (unsigned char*)view;
+    m_size = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle((HANDLE)m_mapping);
+    if (m_file) CloseHandle((HANDLE)m_file);
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+
+void MappedFile::prefetch() {
+    if (!m_data) return;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = m_data;
+    range.NumberOfBytes = m_size;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_fd(-1) {}
+
+bool MappedFile::open(const std::string& path, bool copyOnWrite) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    int prot = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* view = mmap(nullptr, (size_t)st.st_size, prot, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_data = (unsigned char*)view;
+    m_size = (size_t)st.st_size;
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) munmap(m_data, m_size);
+    if (m_fd >= 0) ::close(m_fd);
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+
+void MappedFile::prefetch() {
+    if (m_data) madvise(m_data, m_size, MADV_WILLNEED);
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
@@ -0,0 +1,52 @@
+/*
+ * MappedFile.hpp
+ *
+ *  Read-only (or copy-on-write) memory mapping of a whole file.
+ *
+ */
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+//!  MappedFile.
+/*!
+ Maps a file into memory with mmap (POSIX) or MapViewOfFile (Windows). The mapping is released in
+ the destructor, so anything pointing into data() must not outlive the object.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    //! open
+    /*! Map the whole file. With copyOnWrite the pages are writable, but writes stay private to
+        this process and never reach the file. */
+    bool open(const std::string& path, bool copyOnWrite = false);
+    //! close
+    /*! Unmap and close the file. */
+    void close();
+
+    //! prefetch
+    /*! Ask the OS to start reading the whole file in the background. */
+    void prefetch();
+
+    bool isOpen() const { return m_data != nullptr; }
+    unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    unsigned char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_fd;
+#endif
+};
+
+#endif
@@ -1,12 +1,15 @@
 #include "Quad.hpp"
+#include "TiledTexture.hpp"
+#include "TileShader.hpp"
+#include <algorithm>
 
 // Default constructor: creates a 1:1 aspect ratio quad
-Quad::Quad(){
+Quad::Quad(): m_tileVertexBuffer(0), m_tiles(nullptr), m_tileShader(nullptr){
     init(1.0f); // Default to a square
 };
 
 // Overloaded constructor that takes an aspect ratio
-Quad::Quad(float aspectRatio){
+Quad::Quad(float aspectRatio): m_tileVertexBuffer(0), m_tiles(nullptr), m_tileShader(nullptr){
     init(aspectRatio);
 };
 
@@ -14,6 +17,7 @@ Quad::Quad(float aspectRatio){
 Quad::~Quad(){
     // Cleanup VBO
     glDeleteBuffers(1, &vertexbuffer);
+    if (m_tileVertexBuffer) glDeleteBuffers(1, &m_tileVertexBuffer);
     
 };
 
@@ -44,10 +48,14 @@ void Quad::init(float aspectRatio){
 
 // render() and directRender() are unchanged
 void Quad::render(Camera* camera){
-    bindShaders();
     // Build the model matrix -get from object
     glm::mat4 ModelMatrix = this->getTransform();
     glm::mat4 MVP = camera->getViewProjectionMatrix() * ModelMatrix;
+    if (m_tiles) {
+        renderTiles(MVP);
+        return;
+    }
+    bindShaders();
     // Send our transformation to the currently bound shader,
     // in the "MVP" uniform
     shader->updateMVP(MVP);
@@ -89,3 +97,46 @@ void Quad::directRender(){
     glDisableVertexAttribArray(0);
     
 }
+
+float Quad::texelsPerPixel(Camera* camera, int textureWidth, int textureHeight, int viewportWidth, int viewportHeight){
+    glm::mat4 MVP = camera->getViewProjectionMatrix() * this->getTransform();
+    // bottom left, bottom right and top left corner in pixels
+    glm::vec2 corners[3];
+    for (int c = 0; c < 3; ++c) {
+        glm::vec4 p = MVP * glm::vec4(g_vertex_buffer_data[3 * c], g_vertex_buffer_data[3 * c + 1], 0.0f, 1.0f);
+        if (p.w <= 1e-6f) return 1.0f;
+        corners[c] = glm::vec2((p.x / p.w) * 0.5f * viewportWidth, (p.y / p.w) * 0.5f * viewportHeight);
+    }
+    float widthPx = glm::length(corners[1] - corners[0]);
+    float heightPx = glm::length(corners[2] - corners[0]);
+    if (widthPx < 1e-3f || heightPx < 1e-3f) return 1.0f;
+    return std::max(textureWidth / widthPx, textureHeight / heightPx);
+}
+
+void Quad::setTiles(TiledTexture* tiles, TileShader* tileShader){
+    m_tiles = tiles;
+    m_tileShader = tileShader;
+}
+
+void Quad::renderTiles(const glm::mat4& MVP){
+    // uploads the visible tiles that are missing or stale before anything is drawn
+    const std::vector<TiledTexture::Tile>& visible = m_tiles->update(MVP);
+    if (!m_tileVertexBuffer) {
+        const GLfloat unitSquare[12] = { 0,0, 1,0, 0,1,  0,1, 1,0, 1,1 };
+        glGenBuffers(1, &m_tileVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_tileVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(unitSquare), unitSquare, GL_STATIC_DRAW);
+    }
+    m_tileShader->bind();
+    m_tileShader->updateMVP(MVP);
+
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, m_tileVertexBuffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    for (const TiledTexture::Tile& tile : visible) {
+        glBindTexture(GL_TEXTURE_2D, tile.texture);
+        m_tileShader->setTile(tile);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glDisableVertexAttribArray(0);
+}
@@ -18,6 +18,9 @@
 
 #include "Object.hpp"
 
+class TiledTexture;
+class TileShader;
+
 //!  Quad.
 /*!
  Basic quad class that represents a quad and defines it rendering
@@ -41,13 +44,29 @@ class Quad:  public Object{
         //! directRender
         /*! Direct rendering function that doesnt take camera into account. */
         void directRender();
+        //! setTiles
+        /*! Draw the visible tiles of a TiledTexture with tileShader instead of the quad's own
+            shader and texture (frames larger than one texture). nullptr switches back. */
+        void setTiles(TiledTexture* tiles, TileShader* tileShader);
+        TiledTexture* tiles() const { return m_tiles; }
+        //! texelsPerPixel
+        /*! How many texels of a textureWidth x textureHeight texture stretched over the quad fall on
+            one screen pixel under the current transform, along the more minified edge. Above 1 the
+            quad is minified. */
+        float texelsPerPixel(Camera* camera, int textureWidth, int textureHeight, int viewportWidth, int viewportHeight);
     
     
     private:
+        //! renderTiles
+        /*! Updates the tiles for this MVP and draws one unit square per visible tile. */
+        void renderTiles(const glm::mat4& MVP);
         
         GLfloat g_vertex_buffer_data[18];
         GLuint uvbuffer;
         GLuint vertexbuffer;
+        GLuint m_tileVertexBuffer;  //!< unit square, created with the first tiled render
+        TiledTexture* m_tiles;
+        TileShader* m_tileShader;
     
 };
 
@@ -0,0 +1,51 @@
+/*
+ * RenderTarget.hpp
+ *
+ *  Offscreen framebuffer with a colour texture and depth buffer, for rendering
+ *  without a visible window and reading the result back.
+ *
+ */
+#ifndef RENDERTARGET_HPP
+#define RENDERTARGET_HPP
+
+//!  RenderTarget.
+/*!
+ Framebuffer object of a fixed size. bind() redirects rendering into it and sets the viewport.
+ */
+class RenderTarget {
+public:
+    //! Constructor
+    /*! Creates an RGB8 colour texture and a depth renderbuffer of the given size. */
+    RenderTarget(int width, int height);
+    //! Destructor
+    /*! Deletes the framebuffer and its attachments. */
+    ~RenderTarget();
+
+    //! isComplete
+    /*! False if the driver rejected the framebuffer configuration. */
+    bool isComplete() const { return m_complete; }
+    //! bind
+    /*! Render into this target from now on. */
+    void bind();
+    //! unbind
+    /*! Render into the default framebuffer again, with the given viewport. */
+    static void unbind(int viewportWidth, int viewportHeight);
+    //! readPixels
+    /*! Synchronous BGR readback of the whole target into dst. Rows are bottom-up, stride in bytes. */
+    void readPixels(unsigned char* dst, int stride);
+
+    GLuint getTextureID() const { return m_colorTexture; }
+    GLuint getFramebufferID() const { return m_framebuffer; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+private:
+    GLuint m_framebuffer;
+    GLuint m_colorTexture;
+    GLuint m_depthBuffer;
+    int m_width;
+    int m_height;
+    bool m_complete;
+};
+
+#endif
@@ -19,7 +19,7 @@ using namespace std;
 //#include <GL/glew.h>
 
 
-GLuint Shader::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+GLuint Shader::LoadShaders(const char * vertex_file_path,const char * fragment_file_path,const char * fragment_prelude_path){
 	
 	// Create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
@@ -49,6 +49,25 @@ GLuint Shader::LoadShaders(const char * vertex_file_path,const char * fragment_f
 		FragmentShaderStream.close();
 	}
 	
+	// Splice the shared snippet in after the #version line; #line keeps the fragment shader's
+	// own line numbers in the compile log
+	if(fragment_prelude_path && *fragment_prelude_path){
+		std::ifstream PreludeStream(fragment_prelude_path, std::ios::in);
+		if(PreludeStream.is_open()){
+			std::string PreludeCode = "";
+			std::string Line = "";
+			while(getline(PreludeStream, Line))
+				PreludeCode += "\n" + Line;
+			PreludeStream.close();
+			size_t VersionAt = FragmentShaderCode.find("#version");
+			size_t InsertAt = VersionAt == std::string::npos ? 0 : FragmentShaderCode.find('\n', VersionAt);
+			if(InsertAt == std::string::npos) InsertAt = FragmentShaderCode.size();
+			FragmentShaderCode.insert(InsertAt, PreludeCode + "\n#line 2");
+		}else{
+			printf("Impossible to open %s, compiling %s without it\n", fragment_prelude_path, fragment_file_path);
+		}
+	}
+	
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
 	
@@ -115,8 +134,8 @@ GLuint Shader::LoadShaders(const char * vertex_file_path,const char * fragment_f
 
 
 
-void Shader::initShaders(std::string vertexshaderName, std::string fragmentshaderName){
-	programID = LoadShaders(vertexshaderName.c_str(), fragmentshaderName.c_str());
+void Shader::initShaders(std::string vertexshaderName, std::string fragmentshaderName, std::string fragmentPrelude){
+	programID = LoadShaders(vertexshaderName.c_str(), fragmentshaderName.c_str(), fragmentPrelude.c_str());
 	m_MVPID = glGetUniformLocation(programID, "MVP");
 	m_MID = glGetUniformLocation(programID, "M");
 	m_VID = glGetUniformLocation(programID, "V");
@@ -38,6 +38,13 @@ public:
 	Shader(std::string vertexshaderName, std::string fragmentshaderName){
 		initShaders(vertexshaderName,fragmentshaderName);
 		
+	}
+    //! Constructor with a shared fragment snippet
+    /*! As above; the file fragmentPrelude (e.g. videoSample.glsl) is spliced into the fragment
+     shader right after its #version line, so several shaders can share its functions and uniforms*/
+	Shader(std::string vertexshaderName, std::string fragmentshaderName, std::string fragmentPrelude){
+		initShaders(vertexshaderName,fragmentshaderName,fragmentPrelude);
+		
 	}
     //! Constructor with shader source specification
     /*! Creates the shaders from source, creates vertex and fragment shader at the same time. 
@@ -53,11 +60,12 @@ public:
 	virtual ~Shader();
 	
     //! LoadShaders
-    /*! Does the actual shader loading and compiling*/
-	GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
+    /*! Does the actual shader loading and compiling. fragment_prelude_path, if given, is inserted
+     after the fragment shader's #version line*/
+	GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path,const char * fragment_prelude_path = nullptr);
     //! initShaders
     /*! init shaders*/
-	void initShaders(std::string vertexshaderName, std::string fragmentshaderName);
+	void initShaders(std::string vertexshaderName, std::string fragmentshaderName, std::string fragmentPrelude = "");
 	
     //! updateMatrices
     /*! Updates the values for the model-view projection matrix and the model and view matrix separately*/
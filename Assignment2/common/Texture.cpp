@@ -1,21 +1,63 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <cmath>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 
 #include "Texture.hpp"
 
-Texture::Texture() : m_textureID(0) {}
+// levels of a complete mip chain down to 1x1
+static int fullChainLevels(int width, int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) ++levels;
+    return levels;
+}
+
+Texture::Texture() : m_textureID(0), m_chromaID(0), m_format(FORMAT_BGR), m_yuvWidth(0), m_yuvHeight(0),
+      m_streaming(false), m_nextUpload(0), m_rgbWidth(0), m_rgbHeight(0), m_topDown(false),
+      m_bc1Width(0), m_bc1Height(0), m_width(0), m_height(0),
+      m_mipLevel(0), m_mipsDirty(false), m_mipsUsed(false), m_ringLevels(1),
+      m_ringDepth(1), m_ringIndex(0), m_ringWidth(0), m_ringHeight(0), m_ringActive(false),
+      m_persistentSlots(0), m_persistentBuffer(0), m_persistentData(nullptr), m_slotBytes(0), m_slotWidth(0),
+      m_slotHeight(0), m_nextSlot(0), m_pendingSlot(-1), m_fenceWaits(0) {}
 
-Texture::Texture(std::string filename) {
-    if (filename.find("dds") != std::string::npos || filename.find("DDS") != std::string::npos)
-        m_textureID = loadDDS(filename.c_str());
+Texture::Texture(std::string filename) : m_chromaID(0), m_format(FORMAT_BGR), m_yuvWidth(0), m_yuvHeight(0),
+      m_streaming(false), m_nextUpload(0), m_rgbWidth(0), m_rgbHeight(0), m_topDown(false),
+      m_bc1Width(0), m_bc1Height(0), m_width(0), m_height(0),
+      m_mipLevel(0), m_mipsDirty(false), m_mipsUsed(false), m_ringLevels(1),
+      m_ringDepth(1), m_ringIndex(0), m_ringWidth(0), m_ringHeight(0), m_ringActive(false),
+      m_persistentSlots(0), m_persistentBuffer(0), m_persistentData(nullptr), m_slotBytes(0), m_slotWidth(0),
+      m_slotHeight(0), m_nextSlot(0), m_pendingSlot(-1), m_fenceWaits(0) {
+    printf("Reading image %s\n", filename.c_str());
+    TextureImage image;
+    std::string error;
+    m_textureID = 0;
+    if (parseImage(filename, image, error))
+        m_textureID = uploadImage(image);
     else
-        m_textureID = loadBMP_custom(filename.c_str());
+        printf("%s: %s\n", filename.c_str(), error.c_str());
+}
+
+Texture::Texture(const TextureImage& image) : m_textureID(0), m_chromaID(0), m_format(FORMAT_BGR), m_yuvWidth(0), m_yuvHeight(0),
+      m_streaming(false), m_nextUpload(0), m_rgbWidth(0), m_rgbHeight(0), m_topDown(false),
+      m_bc1Width(0), m_bc1Height(0), m_width(0), m_height(0),
+      m_mipLevel(0), m_mipsDirty(false), m_mipsUsed(false), m_ringLevels(1),
+      m_ringDepth(1), m_ringIndex(0), m_ringWidth(0), m_ringHeight(0), m_ringActive(false),
+      m_persistentSlots(0), m_persistentBuffer(0), m_persistentData(nullptr), m_slotBytes(0), m_slotWidth(0),
+      m_slotHeight(0), m_nextSlot(0), m_pendingSlot(-1), m_fenceWaits(0) {
+    if (image.file && !image.levels.empty())
+        m_textureID = uploadImage(image);
 }
 
-Texture::Texture(int w, int h) {
+Texture::Texture(int w, int h) : m_chromaID(0), m_format(FORMAT_BGR), m_yuvWidth(0), m_yuvHeight(0),
+      m_streaming(false), m_nextUpload(0), m_rgbWidth(0), m_rgbHeight(0), m_topDown(false),
+      m_bc1Width(0), m_bc1Height(0), m_width(0), m_height(0),
+      m_mipLevel(0), m_mipsDirty(false), m_mipsUsed(false), m_ringLevels(1),
+      m_ringDepth(1), m_ringIndex(0), m_ringWidth(0), m_ringHeight(0), m_ringActive(false),
+      m_persistentSlots(0), m_persistentBuffer(0), m_persistentData(nullptr), m_slotBytes(0), m_slotWidth(0),
+      m_slotHeight(0), m_nextSlot(0), m_pendingSlot(-1), m_fenceWaits(0) {
     glGenTextures(1, &m_textureID);
     glBindTexture(GL_TEXTURE_2D, m_textureID);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
@@ -25,7 +67,16 @@ Texture::Texture(int w, int h) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 }
 
-Texture::Texture(unsigned char* data, int width, int height, bool bgrFormat) {
+Texture::Texture(unsigned char* data, int width, int height, bool bgrFormat)
+    : m_chromaID(0), m_format(FORMAT_BGR), m_yuvWidth(0), m_yuvHeight(0),
+      m_streaming(false), m_nextUpload(0), m_rgbWidth(0), m_rgbHeight(0), m_topDown(false),
+      m_bc1Width(0), m_bc1Height(0), m_width(0), m_height(0),
+      m_mipLevel(0), m_mipsDirty(false), m_mipsUsed(false), m_ringLevels(1),
+      m_ringDepth(1), m_ringIndex(0), m_ringWidth(0), m_ringHeight(0), m_ringActive(false),
+      m_persistentSlots(0), m_persistentBuffer(0), m_persistentData(nullptr), m_slotBytes(0), m_slotWidth(0),
+      m_slotHeight(0), m_nextSlot(0), m_pendingSlot(-1), m_fenceWaits(0) {
+    m_width = width;
+    m_height = height;
     glGenTextures(1, &m_textureID);
     glBindTexture(GL_TEXTURE_2D, m_textureID);
     GLenum inputFormat = bgrFormat ? GL_BGR : GL_RGB;
@@ -40,140 +91,495 @@ Texture::Texture(unsigned char* data, int width, int height, bool bgrFormat) {
 Texture::~Texture() {
     if (m_textureID)
         glDeleteTextures(1, &m_textureID);
+    if (m_chromaID)
+        glDeleteTextures(1, &m_chromaID);
+    if (!m_uploadBuffers.empty())
+        glDeleteBuffers((GLsizei)m_uploadBuffers.size(), m_uploadBuffers.data());
+    releasePersistent();
+    releaseRing();
 }
 
 void Texture::bindTexture() {
+    if (m_format == FORMAT_NV12) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_chromaID);
+    }
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    glBindTexture(GL_TEXTURE_2D, getTextureID());
+    // YUV planes and BC1 blocks are always sampled from level 0
+    if (!m_mipsDirty || m_format != FORMAT_BGR || m_bc1Width) return;
+    if (m_mipLevel > 0) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_mipLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        m_mipsUsed = true;
+    } else if (m_mipsUsed) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+    m_mipsDirty = false;
+}
+
+void Texture::uploaded(int width, int height) {
+    m_width = width;
+    m_height = height;
+    m_mipsDirty = true;
+}
+
+int Texture::mipLevelFor(float texelsPerPixel) {
+    // trilinear filtering blends floor(lod) and the level below, so the chain has to reach ceil(lod)
+    if (texelsPerPixel <= 1.0f) return 0;
+    return (int)std::ceil(std::log2(texelsPerPixel));
+}
+
+void Texture::setSampledLevel(int level) {
+    level = std::max(0, std::min(level, fullChainLevels(m_width, m_height) - 1));
+    // the next bind has to rebuild or reset the chain of the frame it holds
+    if (level != m_mipLevel) m_mipsDirty = true;
+    m_mipLevel = level;
 }
 
 GLuint Texture::getTextureID() {
-    return m_textureID;
+    return m_ringActive ? m_ring[m_ringIndex] : m_textureID;
 }
 
-GLuint Texture::loadBMP_custom(const char* imagepath) {
-    printf("Reading image %s\n", imagepath);
+static uint32_t readU32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
 
-    unsigned char header[54];
-    unsigned int dataPos;
-    unsigned int imageSize;
-    unsigned int width, height;
-    unsigned char* data;
+#define FOURCC_DXT1 0x31545844
+#define FOURCC_DXT3 0x33545844
+#define FOURCC_DXT5 0x35545844
 
-    FILE* file = fopen(imagepath, "rb");
-    if (!file) {
-        printf("%s could not be opened.\n", imagepath);
-        return 0;
+// 24bpp uncompressed BMP, bottom-up rows padded to 4 bytes
+static bool parseBMP(const MappedFile& file, TextureImage& image, std::string& error) {
+    const unsigned char* header = file.data();
+    if (file.size() < 54 || header[0] != 'B' || header[1] != 'M') {
+        error = "not a correct BMP file";
+        return false;
     }
+    if (readU32(header + 0x1E) != 0 || readU32(header + 0x1C) != 24) {
+        error = "not a 24bpp BMP file";
+        return false;
+    }
+    int32_t width = (int32_t)readU32(header + 0x12);
+    int32_t height = (int32_t)readU32(header + 0x16);
+    if (width <= 0 || height <= 0) {
+        error = "unsupported BMP size (top-down or empty)";
+        return false;
+    }
+    size_t dataPos = readU32(header + 0x0A);
+    if (dataPos == 0) dataPos = 54;
+    size_t stride = ((size_t)width * 3 + 3) & ~(size_t)3;
+    size_t size = stride * (size_t)height;
+    if (dataPos > file.size() || size > file.size() - dataPos) {
+        error = "truncated BMP file";
+        return false;
+    }
+    image.compressedFormat = 0;
+    image.levels.push_back({dataPos, size, width, height});
+    return true;
+}
+
+// DXT1/3/5 DDS with its stored mip levels
+static bool parseDDS(const MappedFile& file, TextureImage& image, std::string& error) {
+    const unsigned char* data = file.data();
+    if (file.size() < 128 || memcmp(data, "DDS ", 4) != 0) {
+        error = "not a correct DDS file";
+        return false;
+    }
+    const unsigned char* header = data + 4;
+    uint32_t height = readU32(header + 8);
+    uint32_t width = readU32(header + 12);
+    uint32_t mipMapCount = std::max(readU32(header + 24), 1u);
+    uint32_t fourCC = readU32(header + 80);
 
-    if (fread(header, 1, 54, file) != 54) {
-        printf("Not a correct BMP file\n");
-        return 0;
+    size_t blockSize = 16;
+    switch (fourCC) {
+        case FOURCC_DXT1: image.compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; blockSize = 8; break;
+        case FOURCC_DXT3: image.compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+        case FOURCC_DXT5: image.compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+        default:
+            error = "unsupported DDS format (DXT1/3/5 only)";
+            return false;
     }
-    if (header[0] != 'B' || header[1] != 'M') {
-        printf("Not a correct BMP file\n");
-        return 0;
+    if (width == 0 || height == 0 || width > 65536 || height > 65536) {
+        error = "unsupported DDS size";
+        return false;
     }
-    if (*(int*)&(header[0x1E]) != 0 || *(int*)&(header[0x1C]) != 24) {
-        printf("Not a 24bpp BMP file\n");
-        return 0;
+
+    size_t offset = 128;
+    for (uint32_t level = 0; level < mipMapCount; ++level) {
+        size_t size = ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+        if (size > file.size() - offset) {
+            // keep the complete levels of a short file, like the old loader uploaded what it read
+            if (level == 0) {
+                error = "truncated DDS file";
+                return false;
+            }
+            break;
+        }
+        image.levels.push_back({offset, size, (int)width, (int)height});
+        offset += size;
+        if (width == 1 && height == 1) break;
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
     }
+    return true;
+}
 
-    dataPos = *(int*)&(header[0x0A]);
-    imageSize = *(int*)&(header[0x22]);
-    width = *(int*)&(header[0x12]);
-    height = *(int*)&(header[0x16]);
+bool Texture::parseImage(const std::string& path, TextureImage& image, std::string& error) {
+    image = TextureImage();
+    image.file.reset(new MappedFile());
+    if (!image.file->open(path)) {
+        error = "could not be opened";
+        image.file.reset();
+        return false;
+    }
+    image.file->prefetch();
 
-    if (imageSize == 0) imageSize = width * height * 3;
-    if (dataPos == 0) dataPos = 54;
+    bool dds = path.find("dds") != std::string::npos || path.find("DDS") != std::string::npos;
+    bool ok = dds ? parseDDS(*image.file, image, error) : parseBMP(*image.file, image, error);
+    if (!ok) {
+        image.file.reset();
+        image.levels.clear();
+        return false;
+    }
 
-    data = new unsigned char[imageSize];
-    fread(data, 1, imageSize, file);
-    fclose(file);
+    // fault the pixel pages in here, so the upload on the GL thread does not wait for the disk
+    const unsigned char* data = image.file->data();
+    const TextureImage::Level& last = image.levels.back();
+    size_t end = last.offset + last.size;
+    unsigned int sum = 0;
+    for (size_t offset = image.levels.front().offset; offset < end; offset += 4096)
+        sum += data[offset];
+    sum += data[end - 1];
+    volatile unsigned int sink = sum;
+    (void)sink;
+    return true;
+}
 
+GLuint Texture::uploadImage(const TextureImage& image) {
+    const unsigned char* data = image.file->data();
     GLuint textureID;
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
-    delete[] data;
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if (image.compressedFormat == 0) {
+        const TextureImage::Level& level = image.levels[0];
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, level.width, level.height, 0, GL_BGR, GL_UNSIGNED_BYTE,
+                     data + level.offset);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    } else {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t i = 0; i < image.levels.size(); ++i) {
+            const TextureImage::Level& level = image.levels[i];
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, image.compressedFormat, level.width, level.height, 0,
+                                   (GLsizei)level.size, data + level.offset);
+        }
+        // a file with fewer stored levels than the full chain is still complete
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
 
+    m_width = image.levels[0].width;
+    m_height = image.levels[0].height;
     return textureID;
 }
 
-#define FOURCC_DXT1 0x31545844
-#define FOURCC_DXT3 0x33545844
-#define FOURCC_DXT5 0x35545844
+void Texture::update(unsigned char* data, int width, int height, bool bgrFormat) {
+    if (m_streaming) {
+        streamUpload(data, width, height, width * 3, false, bgrFormat ? GL_BGR : GL_RGB);
+        return;
+    }
+    m_format = FORMAT_BGR;
+    m_yuvWidth = m_yuvHeight = 0;
+    m_topDown = false;
+    m_ringActive = false;
+    m_bc1Width = m_bc1Height = 0;
+    uploaded(width, height);
+	 glBindTexture(GL_TEXTURE_2D, m_textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, bgrFormat ? GL_BGR : GL_RGB, GL_UNSIGNED_BYTE, data);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);				
+}
 
-GLuint Texture::loadDDS(const char* imagepath) {
-    unsigned char header[124];
-    FILE* fp = fopen(imagepath, "rb");
-    if (fp == NULL) {
-        printf("%s could not be opened.\n", imagepath);
-        return 0;
+void Texture::uploadPlane(GLuint tex, GLenum internalFormat, GLenum format, const unsigned char* data,
+                          int width, int height, int rowTexels, bool reallocate) {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    if (reallocate) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowTexels);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
 
-    char filecode[4];
-    fread(filecode, 1, 4, fp);
-    if (strncmp(filecode, "DDS ", 4) != 0) {
-        fclose(fp);
-        return 0;
+void Texture::updateYUYV(const unsigned char* data, int width, int height, int stride) {
+    bool reallocate = m_format != FORMAT_YUYV || m_yuvWidth != width || m_yuvHeight != height;
+    m_format = FORMAT_YUYV;
+    m_ringActive = false;
+    m_bc1Width = m_bc1Height = 0;
+    m_yuvWidth = width;
+    m_yuvHeight = height;
+    uploaded(width, height);
+    uploadPlane(m_textureID, GL_RG8, GL_RG, data, width, height, stride / 2, reallocate);
+}
+
+void Texture::updateNV12(const unsigned char* data, int width, int height, int stride) {
+    bool reallocate = m_format != FORMAT_NV12 || m_yuvWidth != width || m_yuvHeight != height;
+    if (!m_chromaID) glGenTextures(1, &m_chromaID);
+    m_format = FORMAT_NV12;
+    m_ringActive = false;
+    m_bc1Width = m_bc1Height = 0;
+    m_yuvWidth = width;
+    m_yuvHeight = height;
+    uploaded(width, height);
+    uploadPlane(m_textureID, GL_R8, GL_RED, data, width, height, stride, reallocate);
+    uploadPlane(m_chromaID, GL_RG8, GL_RG, data + (size_t)stride * height,
+                width / 2, height / 2, stride / 2, reallocate);
+}
+
+void Texture::setStreaming(bool enabled, int bufferCount) {
+    if (!m_uploadBuffers.empty()) {
+        glDeleteBuffers((GLsizei)m_uploadBuffers.size(), m_uploadBuffers.data());
+        m_uploadBuffers.clear();
     }
+    m_streaming = enabled;
+    m_nextUpload = 0;
+    m_rgbWidth = m_rgbHeight = 0;   // storage is (re)allocated by the next upload
+    if (enabled) {
+        m_uploadBuffers.resize(bufferCount < 1 ? 1 : bufferCount);
+        glGenBuffers((GLsizei)m_uploadBuffers.size(), m_uploadBuffers.data());
+    }
+}
 
-    fread(&header, 124, 1, fp);
+bool Texture::updateFlipped(const unsigned char* data, int width, int height, int stride) {
+    if (!m_streaming) return false;
+    streamUpload(data, width, height, stride, true, GL_BGR);
+    return true;
+}
 
-    unsigned int height = *(unsigned int*)&(header[8]);
-    unsigned int width = *(unsigned int*)&(header[12]);
-    unsigned int linearSize = *(unsigned int*)&(header[16]);
-    unsigned int mipMapCount = *(unsigned int*)&(header[24]);
-    unsigned int fourCC = *(unsigned int*)&(header[80]);
+void Texture::streamUpload(const unsigned char* data, int width, int height, int stride, bool flipRows, GLenum format) {
+    bindUploadTarget(width, height);
+    m_topDown = false;
 
-    unsigned int bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize;
-    unsigned char* buffer = (unsigned char*)malloc(bufsize);
-    fread(buffer, 1, bufsize, fp);
-    fclose(fp);
+    const size_t rowBytes = (size_t)width * 3;
+    const size_t bytes = rowBytes * height;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadBuffers[m_nextUpload]);
+    m_nextUpload = (m_nextUpload + 1) % (int)m_uploadBuffers.size();
+    // orphan the old contents so mapping never waits for a transfer still reading them
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_DRAW);
+    unsigned char* dst = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bytes,
+                                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        if (!flipRows && (size_t)stride == rowBytes) {
+            memcpy(dst, data, bytes);
+        } else {
+            for (int y = 0; y < height; ++y)
+                memcpy(dst + rowBytes * y, data + (size_t)stride * (flipRows ? height - 1 - y : y), rowBytes);
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        // source is the bound buffer at offset 0; returns before the copy is done
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, (const void*)0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
 
-    unsigned int format;
-    switch (fourCC) {
-        case FOURCC_DXT1: format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
-        case FOURCC_DXT3: format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
-        case FOURCC_DXT5: format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
-        default:
-            free(buffer);
-            return 0;
+void Texture::allocateRGB(int width, int height) {
+    if (m_format != FORMAT_BGR || m_rgbWidth != width || m_rgbHeight != height) {
+        // storage and sampling state are set up once, not every frame
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        m_rgbWidth = width;
+        m_rgbHeight = height;
+        m_bc1Width = m_bc1Height = 0;
     }
+    m_format = FORMAT_BGR;
+    m_yuvWidth = m_yuvHeight = 0;
+}
 
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+bool Texture::compressedUploadSupported() {
+    return GLAD_GL_EXT_texture_compression_s3tc != 0;
+}
 
-    unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
-    unsigned int offset = 0;
+bool Texture::updateBC1(const unsigned char* blocks, int width, int height) {
+    if (!compressedUploadSupported()) return false;
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    if (m_format != FORMAT_BGR || m_bc1Width != width || m_bc1Height != height) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        m_bc1Width = width;
+        m_bc1Height = height;
+        m_rgbWidth = m_rgbHeight = 0;   // the next uncompressed upload reallocates
+    }
+    m_format = FORMAT_BGR;
+    m_yuvWidth = m_yuvHeight = 0;
+    m_topDown = true;
+    m_ringActive = false;
+    uploaded(width, height);
+    // 8 bytes per 4x4 block; partial blocks at the edges are allowed because the update covers the whole level
+    GLsizei bytes = (GLsizei)(((width + 3) / 4) * ((height + 3) / 4) * 8);
+    glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, bytes, blocks);
+    return true;
+}
 
-    for (unsigned int level = 0; level < mipMapCount && (width || height); ++level) {
-        unsigned int size = ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
-        glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, size, buffer + offset);
-        offset += size;
-        width /= 2;
-        height /= 2;
-        if (width < 1) width = 1;
-        if (height < 1) height = 1;
+bool Texture::setPersistentUpload(bool enabled, int slots) {
+    releasePersistent();
+    m_persistentSlots = 0;
+    if (!enabled) return true;
+    if (!GLAD_GL_VERSION_4_4 && !GLAD_GL_ARB_buffer_storage) return false;
+    m_persistentSlots = slots < 2 ? 2 : slots;
+    m_slotFences.assign(m_persistentSlots, nullptr);
+    return true;
+}
+
+void Texture::releasePersistent() {
+    for (GLsync& fence : m_slotFences) {
+        if (!fence) continue;
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (m_persistentBuffer) {
+        // deleting the buffer also ends the persistent mapping
+        glDeleteBuffers(1, &m_persistentBuffer);
+        m_persistentBuffer = 0;
     }
+    m_persistentData = nullptr;
+    m_slotWidth = m_slotHeight = 0;
+    m_nextSlot = 0;
+    m_pendingSlot = -1;
+}
 
-    free(buffer);
-    return textureID;
+void Texture::allocatePersistent(int width, int height) {
+    int slots = m_persistentSlots;
+    releasePersistent();
+    m_slotFences.assign(slots, nullptr);
+
+    // 256-byte aligned slots, rows tightly packed (UNPACK_ALIGNMENT 1)
+    m_slotBytes = ((size_t)width * 3 * height + 255) & ~(size_t)255;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &m_persistentBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_persistentBuffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)(m_slotBytes * slots), nullptr, flags);
+    m_persistentData = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)(m_slotBytes * slots), flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!m_persistentData) {
+        glDeleteBuffers(1, &m_persistentBuffer);
+        m_persistentBuffer = 0;
+        return;
+    }
+    m_slotWidth = width;
+    m_slotHeight = height;
 }
-void Texture::update(unsigned char* data, int width, int height, bool bgrFormat) {
-   
-	 glBindTexture(GL_TEXTURE_2D, m_textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, bgrFormat ? GL_BGR : GL_RGB, GL_UNSIGNED_BYTE, data);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);				
+
+cv::Mat Texture::beginUpload(int width, int height) {
+    if (!m_persistentSlots) return cv::Mat();
+    if (width != m_slotWidth || height != m_slotHeight) allocatePersistent(width, height);
+    if (!m_persistentData) return cv::Mat();
+
+    const int slot = m_nextSlot;
+    GLsync& fence = m_slotFences[slot];
+    if (fence) {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            ++m_fenceWaits;
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    m_pendingSlot = slot;
+    return cv::Mat(height, width, CV_8UC3, m_persistentData + m_slotBytes * slot, (size_t)width * 3);
+}
+
+void Texture::commitUpload() {
+    if (m_pendingSlot < 0) return;
+    const int slot = m_pendingSlot;
+    m_pendingSlot = -1;
+
+    bindUploadTarget(m_slotWidth, m_slotHeight);
+    m_topDown = true;
+    // the mapping is coherent, so the CPU writes are visible without a flush
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_persistentBuffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_slotWidth, m_slotHeight, GL_BGR, GL_UNSIGNED_BYTE,
+                    (const void*)(m_slotBytes * slot));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_slotFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_nextSlot = (slot + 1) % m_persistentSlots;
+}
+
+void Texture::setRingDepth(int depth) {
+    releaseRing();
+    m_ringDepth = depth < 1 ? 1 : depth;
+}
+
+void Texture::releaseRing() {
+    if (!m_ring.empty()) glDeleteTextures((GLsizei)m_ring.size(), m_ring.data());
+    m_ring.clear();
+    m_ringIndex = 0;
+    m_ringWidth = m_ringHeight = 0;
+    m_ringActive = false;
+}
+
+void Texture::nextRingTexture(int width, int height) {
+    // immutable storage cannot grow a mip chain later, so it is reserved once mipmaps are needed
+    const bool needLevels = m_mipLevel > 0 && m_ringLevels == 1;
+    if (m_ring.empty() || width != m_ringWidth || height != m_ringHeight || needLevels) {
+        // immutable storage cannot be resized, so a new size means new textures
+        const int levels = m_mipLevel > 0 || m_ringLevels > 1 ? fullChainLevels(width, height) : 1;
+        releaseRing();
+        m_ringLevels = levels;
+        m_ring.resize(m_ringDepth);
+        glGenTextures((GLsizei)m_ring.size(), m_ring.data());
+        for (GLuint tex : m_ring) {
+            glBindTexture(GL_TEXTURE_2D, tex);
+            if (GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_storage) {
+                glTexStorage2D(GL_TEXTURE_2D, m_ringLevels, GL_RGB8, width, height);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        m_ringWidth = width;
+        m_ringHeight = height;
+        m_ringIndex = (int)m_ring.size() - 1;
+    }
+    m_ringIndex = (m_ringIndex + 1) % (int)m_ring.size();
+    glBindTexture(GL_TEXTURE_2D, m_ring[m_ringIndex]);
+    m_format = FORMAT_BGR;
+    m_yuvWidth = m_yuvHeight = 0;
+    m_ringActive = true;
+}
+
+void Texture::bindUploadTarget(int width, int height) {
+    uploaded(width, height);
+    if (m_ringDepth > 1) {
+        nextRingTexture(width, height);
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    allocateRGB(width, height);
+    m_ringActive = false;
 }
@@ -10,13 +10,40 @@
 // Include standard headers
 #include <stdio.h>
 #include <stdlib.h>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <opencv2/opencv.hpp>
+
+#include "MappedFile.hpp"
+
+//! TextureImage
+/*! An image file parsed and validated by Texture::parseImage(), ready to upload. The pixels stay
+    in the file mapping, which the image owns, so nothing is copied before glTexImage2D. */
+struct TextureImage {
+    struct Level {
+        size_t offset;      //!< into the mapping
+        size_t size;
+        int width;
+        int height;
+    };
+    std::unique_ptr<MappedFile> file;
+    GLenum compressedFormat = 0;    //!< GL_COMPRESSED_RGBA_S3TC_* for DDS, 0 = 24-bit BGR rows (BMP)
+    std::vector<Level> levels;      //!< BMP: one; DDS: the stored mip levels
+};
+
 class Texture {
 public:
+    //! Format
+    /*! What the texture currently holds. The values are passed to the shaders as yuvFormat. */
+    enum Format { FORMAT_BGR = 0, FORMAT_YUYV = 1, FORMAT_NV12 = 2 };
+
     Texture();
     Texture(std::string filename);
+    //! Texture
+    /*! Uploads an image parsed by parseImage(). Must run on the GL thread. */
+    Texture(const TextureImage& image);
     Texture(int w, int h);
     Texture(unsigned char* data, int width, int height, bool bgrFormat = true);
     ~Texture();
@@ -24,13 +51,145 @@ public:
     void bindTexture();
     GLuint getTextureID();
     void update(unsigned char* data, int width, int height, bool bgrFormat = true);
-
+    //! setStreaming
+    /*! In streaming mode update() keeps the texture storage and writes each frame into the next of
+        bufferCount pixel buffer objects, then updates the texture from it with glTexSubImage2D.
+        The driver copies from the buffer asynchronously, and since consecutive frames use
+        different buffers, writing the next frame does not wait for that copy. */
+    void setStreaming(bool enabled, int bufferCount = 2);
+    bool streaming() const { return m_streaming; }
+    //! updateFlipped
+    /*! Streaming mode only: uploads top-down BGR rows (stride in bytes) bottom-up, flipping them
+        while they are copied into the buffer. Returns false if streaming is off. */
+    bool updateFlipped(const unsigned char* data, int width, int height, int stride);
+    //! setPersistentUpload
+    /*! Uploads BGR frames from a ring of slots in one buffer created with glBufferStorage and
+        mapped once, persistently and coherently. Needs GL 4.4 or ARB_buffer_storage; returns
+        false and stays off without it. */
+    bool setPersistentUpload(bool enabled, int slots = 3);
+    bool persistentUpload() const { return m_persistentSlots > 0; }
+    //! beginUpload
+    /*! Persistent mode: CV_8UC3 view of the next slot, rows top-down. The producer writes the
+        frame straight into it (e.g. as the cv::warpAffine destination), then calls commitUpload().
+        Waits if the GPU is still reading the slot from slots frames ago. Empty if the mode is off. */
+    cv::Mat beginUpload(int width, int height);
+    //! commitUpload
+    /*! Updates the texture from the slot returned by beginUpload() and fences the slot. */
+    void commitUpload();
+    //! fenceWaits
+    /*! How often beginUpload() found its slot still in use by the GPU. */
+    uint64_t fenceWaits() const { return m_fenceWaits; }
+    //! setRingDepth
+    /*! Streaming and persistent BGR uploads rotate through depth textures with immutable storage
+        (glTexStorage2D where available): frame k goes into texture k mod depth and bindTexture()
+        binds the newest one, so an upload never targets a texture that a previous draw may still be
+        sampling. 1 = a single texture. */
+    void setRingDepth(int depth);
+    int ringDepth() const { return m_ringDepth; }
+    //! topDown
+    /*! True if the rows were uploaded top-down, so the shader has to flip them (flipRows). */
+    bool topDown() const { return m_format != FORMAT_BGR || m_topDown; }
+    //! updateYUYV
+    /*! Uploads packed YUYV as a width x height RG8 texture (.r = Y, .g = U/V alternating).
+        Rows are top-down and stride is in bytes; the shader converts and flips. */
+    void updateYUYV(const unsigned char* data, int width, int height, int stride);
+    //! updateNV12
+    /*! Uploads the Y plane (R8) and the interleaved UV plane that follows it (RG8, half size)
+        into two textures; the UV one is bound to texture unit 1. */
+    void updateNV12(const unsigned char* data, int width, int height, int stride);
+    Format format() const { return m_format; }
+    int width() const { return m_width; }     //!< size of the last upload
+    int height() const { return m_height; }
+    //! setSampledLevel
+    /*! Highest mip level the next draws will sample (see mipLevelFor). Above 0, bindTexture()
+        builds the chain of a newly uploaded BGR frame down to that level only, with
+        GL_TEXTURE_MAX_LEVEL capping glGenerateMipmap; 0 samples the frame with GL_LINEAR and
+        builds nothing, so a magnified or 1:1 quad costs no mipmap generation. */
+    void setSampledLevel(int level);
+    int sampledLevel() const { return m_mipLevel; }
+    //! mipLevelFor
+    /*! Deepest level trilinear filtering reaches at texelsPerPixel (texture texels per screen pixel). */
+    static int mipLevelFor(float texelsPerPixel);
+    //! updateBC1
+    /*! Uploads BC1 (DXT1) blocks, top-down, with glCompressedTexSubImage2D into the single texture
+        (no ring). Storage is (re)allocated when the size changes. Returns false without S3TC support. */
+    bool updateBC1(const unsigned char* blocks, int width, int height);
+    static bool compressedUploadSupported();
+    //! parseImage
+    /*! Maps a 24bpp BMP or a DXT1/3/5 DDS file, validates its header against the file size and
+        faults the pixel pages in. Touches no GL state, so it can run on any thread; on failure
+        error says why. */
+    static bool parseImage(const std::string& path, TextureImage& image, std::string& error);
 
 private:
-    GLuint loadBMP_custom(const char* imagepath);
-    GLuint loadDDS(const char* imagepath);
+    //! uploadImage
+    /*! Creates a texture from a parsed image: BMP with a generated mip chain, DDS with its stored levels. */
+    GLuint uploadImage(const TextureImage& image);
+
+    //! uploadPlane
+    /*! (Re)allocates tex when size or format change, then streams the rows in with glTexSubImage2D. */
+    void uploadPlane(GLuint tex, GLenum internalFormat, GLenum format, const unsigned char* data,
+                     int width, int height, int rowTexels, bool reallocate);
+
+    //! streamUpload
+    /*! Streaming-mode upload of BGR/RGB rows through the next pixel buffer object. */
+    void streamUpload(const unsigned char* data, int width, int height, int stride, bool flipRows, GLenum format);
+    //! allocateRGB
+    /*! Allocates RGB storage of the given size once, so uploads can use glTexSubImage2D. Texture must be bound. */
+    void allocateRGB(int width, int height);
+    //! allocatePersistent
+    /*! (Re)creates and maps the persistent buffer for slots of the given size. */
+    void allocatePersistent(int width, int height);
+    void releasePersistent();
+    //! nextRingTexture
+    /*! Advances the texture ring, (re)allocating it for the given size, and binds the new texture. */
+    void nextRingTexture(int width, int height);
+    //! bindUploadTarget
+    /*! Binds the texture a BGR upload of this size goes to: the next ring texture or the single one. */
+    void bindUploadTarget(int width, int height);
+    void releaseRing();
+    //! uploaded
+    /*! Bookkeeping after a new frame went into the texture: its size, and that its mips are stale. */
+    void uploaded(int width, int height);
 
     GLuint m_textureID;
+    GLuint m_chromaID;      //!< NV12 UV plane
+    Format m_format;
+    int m_yuvWidth;         //!< size the YUV textures were allocated with
+    int m_yuvHeight;
+    bool m_streaming;
+    std::vector<GLuint> m_uploadBuffers;    //!< PBOs used round-robin in streaming mode
+    int m_nextUpload;
+    int m_rgbWidth;         //!< size the RGB storage was allocated with in streaming mode
+    int m_rgbHeight;
+    bool m_topDown;         //!< last BGR upload came from a persistent slot or BC1 blocks
+    int m_bc1Width;         //!< size the BC1 storage was allocated with, 0 = texture holds no BC1 storage
+    int m_bc1Height;
+    int m_width;
+    int m_height;
+
+    int m_mipLevel;         //!< level the draws sample down to, 0 = no chain
+    bool m_mipsDirty;       //!< the current frame's chain has not been built yet
+    bool m_mipsUsed;        //!< a chain was built at some point, filtering has to be reset at level 0
+    int m_ringLevels;       //!< levels of the ring textures' immutable storage
+
+    int m_ringDepth;
+    std::vector<GLuint> m_ring;         //!< allocated lazily by the first ring upload
+    int m_ringIndex;                    //!< texture holding the newest frame
+    int m_ringWidth;
+    int m_ringHeight;
+    bool m_ringActive;                  //!< the newest frame lives in the ring, not in m_textureID
+
+    int m_persistentSlots;  //!< 0 = persistent mode off
+    GLuint m_persistentBuffer;
+    unsigned char* m_persistentData;
+    size_t m_slotBytes;
+    int m_slotWidth;
+    int m_slotHeight;
+    std::vector<GLsync> m_slotFences;   //!< set when a slot's upload is queued, waited on before reuse
+    int m_nextSlot;
+    int m_pendingSlot;                  //!< handed out by beginUpload(), -1 if none
+    uint64_t m_fenceWaits;
 };
 
 #endif
\ No newline at end of file
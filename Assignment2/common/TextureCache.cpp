@@ -0,0 +1,105 @@
+#include <glad/gl.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "TextureCache.hpp"
+
+static double msSince(std::chrono::high_resolution_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+}
+
+TextureCache::TextureCache() {}
+
+TextureCache::~TextureCache() {
+    clear();
+}
+
+TextureCache::Entry* TextureCache::find(const std::string& path) {
+    ++m_stats.requests;
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+        ++m_stats.duplicates;
+        return it->second.get();
+    }
+    Entry* entry = new Entry();
+    m_entries[path].reset(entry);
+    entry->parsed = std::async(std::launch::async, [entry, path]() {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        bool ok = Texture::parseImage(path, entry->image, entry->error);
+        entry->parseMs = msSince(t0);
+        return ok;
+    });
+    return entry;
+}
+
+void TextureCache::request(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    find(path);
+}
+
+void TextureCache::finish(const std::string& path, Entry& entry) {
+    if (entry.done) return;
+    bool ok = entry.parsed.get();
+    entry.done = true;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.parseMs += entry.parseMs;
+    if (!ok) {
+        ++m_stats.failed;
+        std::cerr << "[TEXTURES] " << path << ": " << entry.error << "\n";
+        return;
+    }
+    entry.texture = new Texture(entry.image);
+    ++m_stats.loaded;
+    for (const TextureImage::Level& level : entry.image.levels) m_stats.bytesMapped += level.size;
+    // the texture has its own copy now, drop the mapping
+    entry.image = TextureImage();
+}
+
+Texture* TextureCache::get(const std::string& path) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry = find(path);
+    }
+    finish(path, *entry);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.uploadMs += msSince(t0);
+    return entry->texture;
+}
+
+int TextureCache::uploadReady() {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::vector<std::pair<std::string, Entry*>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& it : m_entries) {
+            Entry* entry = it.second.get();
+            if (!entry->done && entry->parsed.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                ready.push_back({it.first, entry});
+        }
+    }
+    for (auto& it : ready) finish(it.first, *it.second);
+    if (!ready.empty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.uploadMs += msSince(t0);
+    }
+    return (int)ready.size();
+}
+
+void TextureCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& it : m_entries) {
+        Entry* entry = it.second.get();
+        if (!entry->done) entry->parsed.wait();
+        delete entry->texture;
+    }
+    m_entries.clear();
+}
+
+TextureCacheStats TextureCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,85 @@
+/*
+ * TextureCache.hpp
+ *
+ *  Image textures (overlays, LUTs) loaded once per path: parsed off the GL thread, uploaded on it.
+ *
+ */
+#ifndef TEXTURECACHE_HPP
+#define TEXTURECACHE_HPP
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Texture.hpp"
+
+//! TextureCacheStats
+/*! Totals since the cache was created. */
+struct TextureCacheStats {
+    int requests = 0;           //!< request() and get() calls
+    int duplicates = 0;         //!< requests for a path that was already requested
+    int loaded = 0;             //!< textures uploaded
+    int failed = 0;             //!< files that could not be opened or parsed
+    double parseMs = 0.0;       //!< mapping, validation and page faults, summed over the worker threads
+    double uploadMs = 0.0;      //!< GL thread time in get()/uploadReady(), including waits for a parse
+    size_t bytesMapped = 0;     //!< pixel data of the loaded files
+};
+
+//!  TextureCache.
+/*!
+ Owns one Texture per path. request() maps and validates the file with Texture::parseImage() on a
+ std::async worker and returns immediately, so files can be requested before the GL context exists
+ and are parsed while the window is created. get() and uploadReady() run on the GL thread and only
+ do the upload, straight from the mapping. Asking for a path again returns the texture that is
+ already there (or in flight) and counts as a duplicate instead of creating a second GL texture.
+ Paths are compared as given.
+ */
+class TextureCache {
+public:
+    TextureCache();
+    ~TextureCache();
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    //! request
+    /*! Starts parsing path in the background unless it was requested before. Any thread. */
+    void request(const std::string& path);
+    //! get
+    /*! GL thread: the texture for path, requesting it and waiting for its parse if needed.
+        nullptr if the file could not be loaded. The cache keeps ownership. */
+    Texture* get(const std::string& path);
+    //! uploadReady
+    /*! GL thread: uploads every texture whose parse has finished, without waiting. Returns how many. */
+    int uploadReady();
+    //! clear
+    /*! GL thread: waits for pending parses and deletes all textures. Must run before the context goes. */
+    void clear();
+
+    TextureCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::future<bool> parsed;
+        TextureImage image;         //!< written by the parse task, read after parsed is ready
+        std::string error;
+        double parseMs = 0.0;
+        bool done = false;          //!< parse result consumed: texture uploaded or the load failed
+        Texture* texture = nullptr;
+    };
+
+    //! find
+    /*! Entry for path, created with its parse started if it is new. Caller holds m_mutex. */
+    Entry* find(const std::string& path);
+    //! finish
+    /*! GL thread: waits for the entry's parse and uploads it. */
+    void finish(const std::string& path, Entry& entry);
+
+    std::map<std::string, std::unique_ptr<Entry>> m_entries;  //!< entries never move, the tasks hold pointers
+    mutable std::mutex m_mutex;
+    TextureCacheStats m_stats;
+};
+
+#endif
@@ -1,21 +1,26 @@
 
 #include "TextureShader.hpp"
 
-TextureShader::TextureShader(){
+TextureShader::TextureShader(): m_yuvFormatID(-1), m_chromaID(-1), m_flipRowsID(-1){
         
     }
 // version of constructor that allows for  vertex and fragment shader with differnt names
-TextureShader::TextureShader(std::string vertexshaderName, std::string fragmentshaderName): Shader(vertexshaderName, fragmentshaderName){
+TextureShader::TextureShader(std::string vertexshaderName, std::string fragmentshaderName): Shader(vertexshaderName, fragmentshaderName, "videoSample.glsl"){
     
     m_TextureID  = glGetUniformLocation(programID, "myTextureSampler");
-    
+    m_yuvFormatID = glGetUniformLocation(programID, "yuvFormat");
+    m_chromaID = glGetUniformLocation(programID, "chromaSampler");
+    m_flipRowsID = glGetUniformLocation(programID, "flipRows");
     
 }
 
 // version of constructor that assumes that vertex and fragment shader have same name
-TextureShader::TextureShader(std::string shaderName): Shader(shaderName){
+TextureShader::TextureShader(std::string shaderName): Shader(shaderName + ".vert", shaderName + ".frag", "videoSample.glsl"){
     
     m_TextureID  = glGetUniformLocation(programID, "myTextureSampler");
+    m_yuvFormatID = glGetUniformLocation(programID, "yuvFormat");
+    m_chromaID = glGetUniformLocation(programID, "chromaSampler");
+    m_flipRowsID = glGetUniformLocation(programID, "flipRows");
     
 }
 
@@ -38,6 +43,10 @@ void TextureShader::bind(){
     m_texture->bindTexture();
     // Set our "myTextureSampler" sampler to user Texture Unit 0
     glUniform1i(m_TextureID, 0);
+    // YUV frames are converted in the fragment shader, NV12 chroma lives in Texture Unit 1
+    glUniform1i(m_yuvFormatID, m_texture->format());
+    glUniform1i(m_chromaID, 1);
+    glUniform1i(m_flipRowsID, m_texture->topDown() ? 1 : 0);
     
 }
 
@@ -5,7 +5,8 @@
 #include "Texture.hpp"
 //!  TextureShader.
 /*!
-Shader for textures. Has a reference to a texture that will be passed to the shader
+Shader for textures. Has a reference to a texture that will be passed to the shader.
+The fragment shader gets videoSample.glsl (sampleVideo(), YUV formats, top-down rows) spliced in.
  */
 class TextureShader: public Shader{
     public:
@@ -37,6 +38,9 @@ class TextureShader: public Shader{
         glm::vec4 color;
         Texture* m_texture;
         GLuint m_TextureID;
+        GLint m_yuvFormatID;    // "yuvFormat" uniform, -1 if the shader has none
+        GLint m_chromaID;       // "chromaSampler" uniform, texture unit 1
+        GLint m_flipRowsID;     // "flipRows" uniform, set for top-down textures
     
     
 };
@@ -0,0 +1,30 @@
+#include "TileShader.hpp"
+
+TileShader::TileShader(std::string fragmentshaderName): Shader("tiledTexture.vert", fragmentshaderName, "videoSample.glsl"){
+
+    // the fragment shaders name their sampler differently, both go to unit 0
+    m_samplerID = glGetUniformLocation(programID, "myTextureSampler");
+    if (m_samplerID < 0) m_samplerID = glGetUniformLocation(programID, "texture1");
+    m_yuvFormatID = glGetUniformLocation(programID, "yuvFormat");
+    m_flipRowsID = glGetUniformLocation(programID, "flipRows");
+    m_tileRectID = glGetUniformLocation(programID, "tileRect");
+    m_frameRectID = glGetUniformLocation(programID, "frameRect");
+    m_frameToTileID = glGetUniformLocation(programID, "frameToTile");
+    m_tileClampID = glGetUniformLocation(programID, "tileClamp");
+
+}
+
+void TileShader::bind(){
+    glUseProgram(programID);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(m_samplerID, 0);
+    glUniform1i(m_yuvFormatID, 0);
+    glUniform1i(m_flipRowsID, 1);
+}
+
+void TileShader::setTile(const TiledTexture::Tile& tile){
+    glUniform4fv(m_tileRectID, 1, &tile.rect[0]);
+    glUniform4fv(m_frameRectID, 1, &tile.frameRect[0]);
+    glUniform4fv(m_frameToTileID, 1, &tile.frameToTile[0]);
+    glUniform4fv(m_tileClampID, 1, &tile.tileClamp[0]);
+}
@@ -0,0 +1,42 @@
+/*
+ * TileShader.hpp
+ *
+ *  Shader for drawing the tiles of a TiledTexture.
+ *
+ */
+#ifndef TILESHADER_HPP
+#define TILESHADER_HPP
+
+#include "Shader.hpp"
+#include "TiledTexture.hpp"
+
+//!  TileShader.
+/*!
+ Pairs tiledTexture.vert, which places a unit square on one tile's model-space rectangle, with one
+ of the video fragment shaders. The tile's texture is bound by the caller; rows are top-down BGR.
+ */
+class TileShader: public Shader{
+    public:
+    //! TileShader
+    /*! Fragment shader as for TextureShader (videoTextureShader.frag, pixelate.frag, sincity.frag),
+        also with videoSample.glsl spliced in. */
+    TileShader(std::string fragmentshaderName);
+
+    //! bind
+    /*! Uses the program with texture unit 0 and top-down BGR sampling. */
+    void bind();
+    //! setTile
+    /*! Rectangle and texture mapping of the tile about to be drawn. */
+    void setTile(const TiledTexture::Tile& tile);
+
+    private:
+        GLint m_samplerID;
+        GLint m_yuvFormatID;
+        GLint m_flipRowsID;
+        GLint m_tileRectID;
+        GLint m_frameRectID;
+        GLint m_frameToTileID;
+        GLint m_tileClampID;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include <glad/gl.h>
+#include <algorithm>
+#include <chrono>
+
+#include "TiledTexture.hpp"
+
+TiledTexture::TiledTexture(int tileSize, size_t budgetBytes)
+    : m_tileSize(tileSize < 64 ? 64 : tileSize), m_budgetBytes(budgetBytes), m_tilesX(0), m_tilesY(0),
+      m_generation(0), m_updateCount(0) {}
+
+TiledTexture::~TiledTexture() {
+    for (auto& entry : m_resident) glDeleteTextures(1, &entry.second.texture);
+}
+
+bool TiledTexture::needsTiling(int width, int height) {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    return width > maxSize || height > maxSize;
+}
+
+size_t TiledTexture::tileBytes() const {
+    // GL_RGB8 is stored with 4 bytes per texel by most drivers
+    return (size_t)m_tileSize * m_tileSize * 4;
+}
+
+void TiledTexture::setImage(const cv::Mat& bgr, bool copy) {
+    CV_Assert(bgr.type() == CV_8UC3);
+    if (copy) {
+        bgr.copyTo(m_owned);
+        m_image = m_owned;
+    } else {
+        m_image = bgr;
+    }
+    int tilesX = (m_image.cols + tileStep() - 1) / tileStep();
+    int tilesY = (m_image.rows + tileStep() - 1) / tileStep();
+    if (tilesX != m_tilesX || tilesY != m_tilesY) {
+        // keys depend on the grid, so a new grid starts from scratch
+        while (!m_lru.empty()) evict(m_lru.back(), true);
+        m_tilesX = tilesX;
+        m_tilesY = tilesY;
+    }
+    ++m_generation;
+}
+
+GLuint TiledTexture::acquireTexture() {
+    if ((m_resident.size() + 1) * tileBytes() > m_budgetBytes && !m_lru.empty()) {
+        int oldest = m_lru.back();
+        Resident& r = m_resident[oldest];
+        if (r.lastUsed != m_updateCount) {
+            GLuint texture = r.texture;
+            evict(oldest, false);
+            return texture;
+        }
+    }
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_storage) {
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB8, m_tileSize, m_tileSize);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, m_tileSize, m_tileSize, 0, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+void TiledTexture::evict(int key, bool freeTexture) {
+    auto it = m_resident.find(key);
+    if (it == m_resident.end()) return;
+    if (freeTexture) glDeleteTextures(1, &it->second.texture);
+    m_lru.erase(it->second.lru);
+    m_resident.erase(it);
+    ++m_stats.evictions;
+}
+
+void TiledTexture::uploadTile(int key, GLuint texture) {
+    const int x0 = (key % m_tilesX) * tileStep(), y0 = (key / m_tilesX) * tileStep();
+    const int w = std::min(tileStep(), m_image.cols - x0), h = std::min(tileStep(), m_image.rows - y0);
+    // the tile's pixels and a one-pixel frame around them; where that frame leaves the image, the
+    // edge pixels are repeated in a staging copy
+    const cv::Rect padded(x0 - 1, y0 - 1, w + 2, h + 2);
+    const cv::Rect inside = padded & cv::Rect(0, 0, m_image.cols, m_image.rows);
+    cv::Mat texels = m_image(inside);
+    if (inside != padded) {
+        cv::copyMakeBorder(texels, m_edgeTile, inside.y - padded.y, padded.br().y - inside.br().y,
+                           inside.x - padded.x, padded.br().x - inside.br().x, cv::BORDER_REPLICATE);
+        texels = m_edgeTile;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    // rows stay top-down, the tile shader flips them
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(texels.step / 3));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texels.cols, texels.rows, GL_BGR, GL_UNSIGNED_BYTE, texels.data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    ++m_stats.uploads;
+    ++m_stats.lastUploads;
+}
+
+const std::vector<TiledTexture::Tile>& TiledTexture::update(const glm::mat4& MVP) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    m_visible.clear();
+    m_stats.lastUploads = 0;
+    ++m_updateCount;
+    if (m_image.empty()) return m_visible;
+
+    const float aspect = (float)m_image.cols / (float)m_image.rows;
+    const float sx = 2.0f * aspect / m_image.cols, sy = 2.0f / m_image.rows;
+    size_t visibleBytes = 0;
+    for (int ty = 0; ty < m_tilesY; ++ty) {
+        for (int tx = 0; tx < m_tilesX; ++tx) {
+            const int x0 = tx * tileStep(), y0 = ty * tileStep();
+            const int x1 = std::min(x0 + tileStep(), m_image.cols), y1 = std::min(y0 + tileStep(), m_image.rows);
+            // image rows run top-down, model-space y runs up
+            const glm::vec4 rect(-aspect + x0 * sx, 1.0f - y1 * sy, -aspect + x1 * sx, 1.0f - y0 * sy);
+
+            // conservative test: the corners' bounding box in NDC against the view, and anything
+            // reaching behind the camera counts as visible
+            float loX = 1e30f, loY = 1e30f, hiX = -1e30f, hiY = -1e30f;
+            bool behind = false;
+            for (int c = 0; c < 4; ++c) {
+                glm::vec4 p = MVP * glm::vec4(c & 1 ? rect.z : rect.x, c & 2 ? rect.w : rect.y, 0.0f, 1.0f);
+                if (p.w <= 1e-6f) { behind = true; break; }
+                loX = std::min(loX, p.x / p.w); hiX = std::max(hiX, p.x / p.w);
+                loY = std::min(loY, p.y / p.w); hiY = std::max(hiY, p.y / p.w);
+            }
+            if (!behind && (hiX < -1.0f || loX > 1.0f || hiY < -1.0f || loY > 1.0f)) continue;
+
+            const int key = ty * m_tilesX + tx;
+            auto it = m_resident.find(key);
+            if (it == m_resident.end()) {
+                GLuint texture = acquireTexture();
+                m_lru.push_front(key);
+                it = m_resident.emplace(key, Resident{ texture, 0, 0, m_lru.begin() }).first;
+            } else {
+                m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+            }
+            Resident& r = it->second;
+            r.lastUsed = m_updateCount;
+            if (r.generation != m_generation) {
+                uploadTile(key, r.texture);
+                r.generation = m_generation;
+            }
+            visibleBytes += tileBytes();
+            // frame pixel x lands on tile texel x - x0 + 1, after the border
+            const float texel = 1.0f / m_tileSize;
+            m_visible.push_back({ r.texture, rect,
+                                  glm::vec4((float)x0 / m_image.cols, (float)y0 / m_image.rows,
+                                            (float)x1 / m_image.cols, (float)y1 / m_image.rows),
+                                  glm::vec4(m_image.cols * texel, m_image.rows * texel, (1 - x0) * texel, (1 - y0) * texel),
+                                  glm::vec4(0.5f * texel, 0.5f * texel, (x1 - x0 + 1.5f) * texel, (y1 - y0 + 1.5f) * texel) });
+        }
+    }
+    if (visibleBytes > m_budgetBytes) ++m_stats.overBudget;
+
+    // a lowered budget, or a frame where the visible tiles alone overshot it: free what is not on screen
+    while (m_resident.size() * tileBytes() > m_budgetBytes && !m_lru.empty()
+           && m_resident[m_lru.back()].lastUsed != m_updateCount)
+        evict(m_lru.back(), true);
+
+    m_stats.lastUpdateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    return m_visible;
+}
+
+TileStats TiledTexture::stats() const {
+    TileStats s = m_stats;
+    s.tilesX = m_tilesX;
+    s.tilesY = m_tilesY;
+    s.visible = (int)m_visible.size();
+    s.resident = (int)m_resident.size();
+    s.residentBytes = m_resident.size() * tileBytes();
+    s.budgetBytes = m_budgetBytes;
+    return s;
+}
@@ -0,0 +1,118 @@
+/*
+ * TiledTexture.hpp
+ *
+ *  Frames larger than GL_MAX_TEXTURE_SIZE, split into fixed-size tiles that are only uploaded
+ *  while they are visible.
+ *
+ */
+#ifndef TILEDTEXTURE_HPP
+#define TILEDTEXTURE_HPP
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <opencv2/opencv.hpp>
+
+//! TileStats
+/*! Counters of a TiledTexture; uploads and evictions are totals, the rest describe the last update. */
+struct TileStats {
+    int tilesX = 0;
+    int tilesY = 0;
+    int visible = 0;            //!< tiles drawn by the last update
+    int resident = 0;           //!< tiles that have a GL texture
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;
+    int lastUploads = 0;        //!< tiles uploaded by the last update
+    double lastUpdateMs = 0.0;  //!< visibility test and uploads of the last update
+    uint64_t uploads = 0;
+    uint64_t evictions = 0;     //!< resident tiles recycled or freed to stay within the budget
+    uint64_t overBudget = 0;    //!< updates whose visible tiles alone did not fit the budget
+};
+
+//!  TiledTexture.
+/*!
+ Holds a BGR frame of any size on the CPU and mirrors it on the GPU as tileSize x tileSize tiles.
+ update() tests every tile against the clip volume under the quad's MVP and only uploads the
+ visible tiles that are missing or older than the current frame, so panning over a 16K still or
+ zooming into an 8K video moves a few tiles per frame instead of the whole image. Resident tiles
+ are kept in LRU order; once the memory budget is reached the least recently used invisible tile's
+ texture is recycled. Each tile texture holds (tileSize - 2)^2 image pixels plus a one-texel border
+ copied from its neighbours (at the image edge, the edge pixel repeated), so bilinear filtering at
+ tile borders and image edges gives what one big texture with CLAMP_TO_EDGE would: no seams, and
+ the unused texels of an edge tile are never sampled. The fragment shaders work in frame texture
+ coordinates, as on an untiled quad, and only map them into the tile for the texture lookup, so
+ effects like pixelate line up across tiles. A lookup that lands beyond the border (a pixelate
+ block starting in the neighbouring tile) takes the nearest border texel.
+ */
+class TiledTexture {
+public:
+    //! Tile
+    /*! One visible tile as Quad draws it. */
+    struct Tile {
+        GLuint texture;
+        glm::vec4 rect;         //!< model space: x0, y0 (bottom left), x1, y1 (top right)
+        glm::vec4 frameRect;    //!< frame texture coordinates the tile covers, top-down: u0, v0, u1, v1
+        glm::vec4 frameToTile;  //!< frame to tile texture coordinates: scale (xy), offset (zw)
+        glm::vec4 tileClamp;    //!< tile texture coordinates of the outermost border texel centres
+    };
+
+    TiledTexture(int tileSize = 1024, size_t budgetBytes = (size_t)512 << 20);
+    ~TiledTexture();
+
+    //! setImage
+    /*! Takes a new CV_8UC3 frame. With copy = false the caller keeps the pixels unchanged until
+        the next setImage(). All resident tiles become stale and are re-uploaded when next visible. */
+    void setImage(const cv::Mat& bgr, bool copy = true);
+    //! update
+    /*! Finds the tiles visible under MVP (the image spans [-aspect, aspect] x [-1, 1] in model
+        space, like Quad), uploads the missing and stale ones and returns them for drawing. */
+    const std::vector<Tile>& update(const glm::mat4& MVP);
+
+    int tileSize() const { return m_tileSize; }
+    void setBudget(size_t bytes) { m_budgetBytes = bytes; }
+    cv::Size size() const { return m_image.size(); }
+    TileStats stats() const;
+
+    //! needsTiling
+    /*! True if a width x height frame does not fit into one texture on this context. */
+    static bool needsTiling(int width, int height);
+
+private:
+    struct Resident {
+        GLuint texture;
+        uint64_t generation;        //!< frame the tile was uploaded from
+        uint64_t lastUsed;          //!< update that last drew it
+        std::list<int>::iterator lru;
+    };
+
+    //! acquireTexture
+    /*! A texture for one more tile: the least recently used invisible tile's when the budget is
+        full, a newly allocated one otherwise. */
+    GLuint acquireTexture();
+    void uploadTile(int key, GLuint texture);
+    void evict(int key, bool freeTexture);
+    size_t tileBytes() const;
+    //! tileStep
+    /*! Image pixels per tile side, the texture minus its border. */
+    int tileStep() const { return m_tileSize - 2; }
+
+    int m_tileSize;
+    size_t m_budgetBytes;
+    cv::Mat m_image;
+    cv::Mat m_owned;            //!< backing store when setImage() copies
+    cv::Mat m_edgeTile;         //!< staging for tiles at the image edge, whose border is made up
+    int m_tilesX;
+    int m_tilesY;
+    uint64_t m_generation;
+    uint64_t m_updateCount;
+
+    std::unordered_map<int, Resident> m_resident;   //!< key = ty * tilesX + tx
+    std::list<int> m_lru;                           //!< most recently used first
+    std::vector<Tile> m_visible;
+    TileStats m_stats;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+int g_sharedThreads = 0;
+int g_sharedTileWidth = 256;
+int g_sharedTileHeight = 32;
+
+// > 0 on pool workers and inside run(): a nested run() then runs inline
+thread_local int t_depth = 0;
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PoolWorkerStats workerDelta(const PoolWorkerStats& a, const PoolWorkerStats& b, double wallMs) {
+    PoolWorkerStats d;
+    d.tasks = a.tasks - b.tasks;
+    d.stolen = a.stolen - b.stolen;
+    d.busyMs = a.busyMs - b.busyMs;
+    d.utilization = wallMs > 0.0 ? d.busyMs / wallMs : 0.0;
+    return d;
+}
+
+}
+
+PoolStats PoolStats::operator-(const PoolStats& other) const {
+    PoolStats d;
+    d.wallMs = wallMs - other.wallMs;
+    for (size_t i = 0; i < workers.size(); ++i)
+        d.workers.push_back(workerDelta(workers[i], i < other.workers.size() ? other.workers[i] : PoolWorkerStats(), d.wallMs));
+    d.callers = workerDelta(callers, other.callers, d.wallMs);
+    return d;
+}
+
+double PoolStats::averageUtilization(int n) const {
+    const int count = n < 0 ? (int)workers.size() : std::min(n, (int)workers.size());
+    double sum = callers.utilization;
+    for (int i = 0; i < count; ++i) sum += workers[i].utilization;
+    return sum / (count + 1);
+}
+
+WorkStealingPool::WorkStealingPool(int threads, int tileWidth, int tileHeight)
+    : m_activeThreads(0), m_tileWidth(std::max(1, tileWidth)), m_tileHeight(std::max(1, tileHeight)),
+      m_startNs(steadyNowNs()), m_generation(0), m_running(true) {
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads - 1; ++i) {
+        m_queues.emplace_back(new Queue());
+        m_counters.emplace_back(new Counters());
+    }
+    for (int i = 0; i < threads - 1; ++i) m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_threads) t.join();
+}
+
+void WorkStealingPool::configure(int threads, int tileWidth, int tileHeight) {
+    g_sharedThreads = threads;
+    g_sharedTileWidth = tileWidth;
+    g_sharedTileHeight = tileHeight;
+}
+
+WorkStealingPool& WorkStealingPool::shared() {
+    static WorkStealingPool pool(g_sharedThreads, g_sharedTileWidth, g_sharedTileHeight);
+    return pool;
+}
+
+void WorkStealingPool::setActiveThreads(int threads) {
+    m_activeThreads = std::max(0, threads);
+}
+
+int WorkStealingPool::activeThreads() const {
+    const int active = m_activeThreads.load();
+    return active > 0 ? std::min(active, threads()) : threads();
+}
+
+void WorkStealingPool::setTileSize(int width, int height) {
+    m_tileWidth = std::max(1, width);
+    m_tileHeight = std::max(1, height);
+}
+
+void WorkStealingPool::run(int tasks, const Task& task, int threads) {
+    if (tasks <= 0) return;
+    int participants = std::min(threads > 0 ? threads : activeThreads(), this->threads());
+    participants = std::min(participants, tasks);
+    if (participants <= 1 || t_depth > 0) {
+        const int64_t t0 = steadyNowNs();
+        ++t_depth;
+        for (int i = 0; i < tasks; ++i) task(i);
+        --t_depth;
+        m_callerCounters.tasks += tasks;
+        m_callerCounters.busyNs += steadyNowNs() - t0;
+        return;
+    }
+
+    Job job;
+    job.task = &task;
+    job.workers = participants - 1;
+    job.remaining = tasks;
+    // contiguous chunks, so neighbouring tiles are worked on by the same thread
+    for (int w = 0; w < job.workers; ++w) {
+        const int begin = (int)((int64_t)tasks * w / job.workers);
+        const int end = (int)((int64_t)tasks * (w + 1) / job.workers);
+        std::lock_guard<std::mutex> lock(m_queues[w]->mutex);
+        for (int i = begin; i < end; ++i) m_queues[w]->items.push_back(Item{ &job, i });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    // help while there are tasks to take, then sleep until the workers finish the ones they are on;
+    // spinning here would take a core from the thread running the last tile. The job lives on this
+    // stack, so the wait goes through its mutex even if everything is done already: the thread that
+    // finished it may still be notifying.
+    ++t_depth;
+    Item item;
+    bool stolen = false;
+    while (take(-1, item, stolen)) execute(item, false, m_callerCounters);
+    --t_depth;
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.finished.wait(lock, [&] { return job.done; });
+}
+
+bool WorkStealingPool::take(int self, Item& item, bool& stolen) {
+    const int n = (int)m_queues.size();
+    if (self >= 0) {
+        Queue& own = *m_queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            item = own.items.front();
+            own.items.pop_front();
+            stolen = false;
+            return true;
+        }
+    }
+    // the back of another deque is the work its owner would get to last
+    for (int k = 1; k <= n; ++k) {
+        const int victim = (self + k + n) % n;
+        if (victim == self) continue;
+        Queue& q = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty() || (self >= 0 && q.items.back().job->workers <= self)) continue;
+        item = q.items.back();
+        q.items.pop_back();
+        stolen = true;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::execute(const Item& item, bool stolen, Counters& counters) {
+    const int64_t t0 = steadyNowNs();
+    (*item.job->task)(item.index);
+    counters.busyNs += steadyNowNs() - t0;
+    ++counters.tasks;
+    if (stolen) ++counters.stolen;
+    // the last task wakes the job's owner, under the job's mutex: the owner returns, and the job
+    // is gone, only once that is released
+    Job* job = item.job;
+    if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done = true;
+        job->finished.notify_one();
+    }
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    t_depth = 1;
+    Counters& counters = *m_counters[index];
+    for (;;) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            if (!m_running) return;
+            seen = m_generation;
+        }
+        Item item;
+        bool stolen = false;
+        while (take(index, item, stolen)) execute(item, stolen, counters);
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [&] { return !m_running || m_generation != seen; });
+    }
+}
+
+PoolStats WorkStealingPool::stats() const {
+    PoolStats s;
+    s.wallMs = (steadyNowNs() - m_startNs) / 1e6;
+    for (const std::unique_ptr<Counters>& c : m_counters) {
+        PoolWorkerStats w;
+        w.tasks = c->tasks.load();
+        w.stolen = c->stolen.load();
+        w.busyMs = c->busyNs.load() / 1e6;
+        w.utilization = s.wallMs > 0.0 ? w.busyMs / s.wallMs : 0.0;
+        s.workers.push_back(w);
+    }
+    s.callers.tasks = m_callerCounters.tasks.load();
+    s.callers.busyMs = m_callerCounters.busyNs.load() / 1e6;
+    s.callers.utilization = s.wallMs > 0.0 ? s.callers.busyMs / s.wallMs : 0.0;
+    return s;
+}
@@ -0,0 +1,140 @@
+/*
+ * WorkStealingPool.hpp
+ *
+ *  Fixed set of worker threads with one task deque each; idle workers steal from the others.
+ *  Runs the CPU path's filters and warps tile by tile.
+ *
+ */
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! PoolWorkerStats
+/*! Counters of one worker thread, or of all calling threads together. */
+struct PoolWorkerStats {
+    uint64_t tasks = 0;         //!< tasks run
+    uint64_t stolen = 0;        //!< of those, taken from another worker's deque
+    double busyMs = 0.0;        //!< time spent inside tasks
+    double utilization = 0.0;   //!< busyMs over the wall time of the snapshot (or of the difference)
+};
+
+//! PoolStats
+/*! Snapshot of the pool counters. Subtract two snapshots to get per-run numbers. */
+struct PoolStats {
+    double wallMs = 0.0;                    //!< since the pool started
+    std::vector<PoolWorkerStats> workers;   //!< one per worker thread
+    PoolWorkerStats callers;                //!< threads that called run() and helped with their tasks
+
+    PoolStats operator-(const PoolStats& other) const;
+    //! averageUtilization
+    /*! Mean utilization of the first n workers and the callers (all workers for n < 0). */
+    double averageUtilization(int n = -1) const;
+};
+
+//!  WorkStealingPool.
+/*!
+ threads() - 1 worker threads, each with its own task deque; the thread calling run() is the last
+ participant. run() deals a job's tasks out in contiguous chunks, so neighbouring tiles stay on one
+ worker, then helps while there are tasks to take and sleeps until the workers have finished theirs.
+ A worker takes its own tasks from the front and, once its deque is empty, steals from the back of
+ the others', so a worker slowed down by other load simply ends up with fewer tasks. Several threads may run jobs at the same time (the latest-frame
+ worker filters while the window thread warps); their tasks interleave. A run() from inside a task
+ runs inline. Tasks must not throw.
+
+ shared() is the process-wide pool the CPU filters use, sized by configure().
+ */
+class WorkStealingPool {
+public:
+    //! Task
+    /*! Called with the task index, 0 .. tasks - 1. */
+    typedef std::function<void(int)> Task;
+
+    //! WorkStealingPool
+    /*! threads participants including the caller of run(), 0 = one per hardware thread. The
+        default tile, 256 x 32 BGR pixels, is 24 KB: source and destination tile fit in L2. */
+    explicit WorkStealingPool(int threads = 0, int tileWidth = 256, int tileHeight = 32);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    //! configure
+    /*! Size and tile shape of the shared pool. Call before shared() is first used. */
+    static void configure(int threads, int tileWidth, int tileHeight);
+    //! shared
+    /*! The process-wide pool, created on first use. */
+    static WorkStealingPool& shared();
+
+    //! run
+    /*! Runs task(0) .. task(tasks - 1) on at most threads participants (0 = activeThreads()) and
+        returns when all have finished. */
+    void run(int tasks, const Task& task, int threads = 0);
+
+    int threads() const { return (int)m_queues.size() + 1; }
+    //! setActiveThreads
+    /*! Participants used by run() calls that pass threads = 0, e.g. for a scaling sweep.
+        0 = all. Takes effect for jobs started afterwards. */
+    void setActiveThreads(int threads);
+    int activeThreads() const;
+
+    //! tileWidth / tileHeight
+    /*! Pixel size of the tiles the CPU filters split a frame into. */
+    int tileWidth() const { return m_tileWidth; }
+    int tileHeight() const { return m_tileHeight; }
+    void setTileSize(int width, int height);
+
+    PoolStats stats() const;
+
+private:
+    struct Job {
+        const Task* task;
+        int workers;                    //!< worker threads allowed to take its tasks
+        std::atomic<int> remaining;
+        std::mutex mutex;               //!< guards done; the caller sleeps on finished for the last tasks
+        std::condition_variable finished;
+        bool done = false;
+    };
+    struct Item {
+        Job* job;
+        int index;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Item> items;
+    };
+    struct Counters {
+        std::atomic<uint64_t> tasks;
+        std::atomic<uint64_t> stolen;
+        std::atomic<int64_t> busyNs;
+        Counters() : tasks(0), stolen(0), busyNs(0) {}
+    };
+
+    void workerLoop(int index);
+    //! take
+    /*! Next task for worker self (-1 = a caller): its own front first, then the back of the others'. */
+    bool take(int self, Item& item, bool& stolen);
+    void execute(const Item& item, bool stolen, Counters& counters);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::unique_ptr<Counters>> m_counters;
+    Counters m_callerCounters;
+    std::vector<std::thread> m_threads;
+    std::atomic<int> m_activeThreads;
+    int m_tileWidth, m_tileHeight;
+    int64_t m_startNs;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    uint64_t m_generation;              //!< bumped whenever tasks are queued, under m_wakeMutex
+    bool m_running;
+};
+
+#endif
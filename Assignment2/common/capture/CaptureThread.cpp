@@ -0,0 +1,132 @@
+#include "CaptureThread.hpp"
+
+#include <chrono>
+
+CaptureThread::CaptureThread(FrameSource& source, size_t ringSize)
+    : m_source(source), m_ring(ringSize), m_running(false), m_sequence(0), m_decodeThreads(2) {}
+
+CaptureThread::~CaptureThread() {
+    stop();
+}
+
+void CaptureThread::start() {
+    if (m_running.load()) return;
+
+    if (m_source.holdsBuffers()) {
+        m_ring.setReleaseCallback([this](FrameSlot& slot) { m_source.releaseFrame(slot.frame); });
+    }
+
+    // YUV frames have their own layout; those slots get sized by the first read instead
+    cv::Size size = resolution();
+    if (size.width > 0 && size.height > 0 && m_source.pixelFormat() == FRAME_BGR24) {
+        m_ring.preallocate(size.width, size.height, CV_8UC3);
+    }
+
+    if (m_source.isCompressed()) {
+        // allow each worker one frame plus one waiting, beyond that the frame is stale anyway
+        size_t inFlight = (size_t)(m_decodeThreads > 0 ? 2 * m_decodeThreads : 1);
+        m_decoder.reset(new JpegDecodePool(m_decodeThreads, inFlight,
+            [this](cv::Mat& frame, int64_t timeNs) { publishDecoded(frame, timeNs); }));
+    }
+
+    m_running = true;
+    m_thread = std::thread(&CaptureThread::run, this);
+}
+
+void CaptureThread::stop() {
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+    m_decoder.reset();
+}
+
+FrameSlot* CaptureThread::waitForFrame(int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (std::chrono::steady_clock::now() < deadline) {
+        FrameSlot* slot = m_ring.acquireLatest();
+        if (slot) return slot;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return nullptr;
+}
+
+bool CaptureThread::setResolution(int width, int height) {
+    bool wasRunning = m_running.load();
+    stop();
+
+    // hand every buffer back before the source tears down its old ones
+    m_ring.acquireLatest();
+    m_ring.release();
+
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(m_sourceMutex);
+        ok = m_source.setResolution(width, height);
+    }
+    if (wasRunning) start();
+    return ok;
+}
+
+cv::Size CaptureThread::resolution() {
+    std::lock_guard<std::mutex> lock(m_sourceMutex);
+    return m_source.resolution();
+}
+
+CaptureStats CaptureThread::stats() const {
+    CaptureStats s;
+    s.captured = m_ring.captured();
+    s.consumed = m_ring.consumed();
+    s.dropped = m_ring.dropped();
+    return s;
+}
+
+bool CaptureThread::readFrame(cv::Mat& frame) {
+    std::lock_guard<std::mutex> lock(m_sourceMutex);
+    return m_source.read(frame) && !frame.empty();
+}
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CaptureThread::publishDecoded(cv::Mat& frame, int64_t captureTimeNs) {
+    if (m_callback) m_callback(frame, captureTimeNs);
+
+    FrameSlot* slot = m_ring.beginWrite();
+    // the pool gets the slot's old buffer back as its next decode target
+    cv::swap(slot->frame, frame);
+    slot->sequence = m_sequence++;
+    slot->captureTimeNs = captureTimeNs;
+    m_ring.commitWrite();
+}
+
+void CaptureThread::run() {
+    while (m_running.load()) {
+        if (m_decoder) {
+            // compressed frames are tiny; read each into its own buffer and let the pool own it
+            cv::Mat compressed;
+            if (!readFrame(compressed)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(3));
+                continue;
+            }
+            if (!m_decoder->submit(std::move(compressed), steadyNowNs())) m_ring.dropWrite();
+            continue;
+        }
+
+        // A full ring gives up its oldest unread frame on commit, so the newest one always gets in
+        // and a failed read drops nothing.
+        FrameSlot* slot = m_ring.beginWrite();
+
+        if (!readFrame(slot->frame)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(3));
+            continue;
+        }
+
+        int64_t timeNs = steadyNowNs();
+        if (m_callback) m_callback(slot->frame, timeNs);
+
+        slot->sequence = m_sequence++;
+        slot->captureTimeNs = timeNs;
+        m_ring.commitWrite();
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * CaptureThread.hpp
+ *
+ *  Reads a FrameSource on its own thread and publishes frames into a FrameRing,
+ *  so a blocking read never stalls GL submission on the render thread.
+ *
+ */
+#ifndef CAPTURETHREAD_HPP
+#define CAPTURETHREAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "FrameRing.hpp"
+#include "FrameSource.hpp"
+#include "JpegDecodePool.hpp"
+
+//! CaptureStats
+/*! Snapshot of the ring counters. Subtract two snapshots to get per-run numbers. */
+struct CaptureStats {
+    uint64_t captured = 0;  //!< frames read from the camera
+    uint64_t consumed = 0;  //!< frames handed to the render loop
+    uint64_t dropped = 0;   //!< frames never seen by the render loop
+
+    CaptureStats operator-(const CaptureStats& other) const {
+        CaptureStats d;
+        d.captured = captured - other.captured;
+        d.consumed = consumed - other.consumed;
+        d.dropped = dropped - other.dropped;
+        return d;
+    }
+};
+
+//! CaptureThread
+/*!
+ Owns the producer side of a FrameRing. The render loop calls acquireLatest()/release() and
+ never waits on the camera.
+ */
+class CaptureThread {
+public:
+    //! Constructor
+    /*! The source must already be opened. */
+    CaptureThread(FrameSource& source, size_t ringSize = 4);
+    //! Destructor
+    /*! Stops the thread if it is still running. */
+    ~CaptureThread();
+
+    //! start
+    /*! Preallocates the ring at the current capture size and starts reading. */
+    void start();
+    //! stop
+    /*! Stops reading and joins the thread. */
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    //! acquireLatest
+    /*! Newest captured frame or nullptr if none arrived since the last call. Never blocks. */
+    FrameSlot* acquireLatest() { return m_ring.acquireLatest(); }
+    //! release
+    /*! Give the slot from acquireLatest() back to the capture thread. */
+    void release() { m_ring.release(); }
+    //! waitForFrame
+    /*! Blocks until a frame is available or the timeout expires. Only meant for startup. */
+    FrameSlot* waitForFrame(int timeoutMs);
+
+    //! setResolution
+    /*! Changes the capture size. Must be called from the consumer thread: the capture thread is
+        stopped and every frame still in the ring is released before the source is reconfigured. */
+    bool setResolution(int width, int height);
+    //! resolution
+    /*! Size the source currently delivers. */
+    cv::Size resolution();
+    //! source
+    /*! The underlying source, e.g. for its name. Do not read from it directly. */
+    FrameSource& source() { return m_source; }
+
+    //! stats
+    /*! Current captured/consumed/dropped counters. */
+    CaptureStats stats() const;
+
+    //! setDecodeThreads
+    /*! Worker count for compressed sources, 0 decodes on the capture thread. Set before start(). */
+    void setDecodeThreads(int threads) { m_decodeThreads = threads; }
+    //! decoder
+    /*! The decode pool while a compressed source is running, otherwise nullptr. */
+    const JpegDecodePool* decoder() const { return m_decoder.get(); }
+
+    //! FrameCallback
+    /*! Called for every decoded frame, including ones a full ring drops later, before the frame
+        is published. Runs on the capture thread or, for compressed sources, on a
+        decode worker (one call at a time, in capture order). */
+    typedef std::function<void(const cv::Mat& frame, int64_t captureTimeNs)> FrameCallback;
+    //! setFrameCallback
+    /*! Must be set before start(). Used e.g. to record the session. */
+    void setFrameCallback(FrameCallback callback) { m_callback = callback; }
+
+private:
+    void run();
+    bool readFrame(cv::Mat& frame);
+    //! publishDecoded
+    /*! Decode pool sink: swaps the frame into a free ring slot. */
+    void publishDecoded(cv::Mat& frame, int64_t captureTimeNs);
+
+    FrameSource& m_source;
+    std::mutex m_sourceMutex;       //!< guards m_source between the capture thread and property changes
+    FrameRing m_ring;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    uint64_t m_sequence;
+    FrameCallback m_callback;
+    int m_decodeThreads;
+    std::unique_ptr<JpegDecodePool> m_decoder;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "FrameRing.hpp"
+
+#include <thread>
+
+namespace {
+// low bit of m_state: the consumer owns the slots from tail up to head while it takes the newest
+const uint64_t kBusy = 1;
+}
+
+FrameRing::FrameRing(size_t capacity)
+    : m_slots(capacity < 2 ? 2 : capacity), m_lent(m_slots.size(), 0),
+      m_head(0), m_state(0), m_holding(false), m_writingSpare(false),
+      m_captured(0), m_consumed(0), m_dropped(0) {}
+
+void FrameRing::preallocate(int width, int height, int type) {
+    for (auto& slot : m_slots) {
+        // drop views of source-owned buffers before allocating our own
+        slot.frame.release();
+        slot.frame.create(height, width, type);
+    }
+    m_held.frame.release();
+    m_held.frame.create(height, width, type);
+    m_spare.frame.release();
+    m_spare.frame.create(height, width, type);
+}
+
+FrameSlot* FrameRing::beginWrite() {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    const uint64_t state = m_state.load(std::memory_order_acquire);
+    // full: the oldest unread frame stays readable until the new one is actually there
+    m_writingSpare = head - (state >> 1) >= m_slots.size();
+    return m_writingSpare ? &m_spare : &m_slots[head % m_slots.size()];
+}
+
+void FrameRing::commitWrite() {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t state = m_state.load(std::memory_order_acquire);
+    while (head - (state >> 1) >= m_slots.size()) {
+        // full: drop the oldest unread frame, unless the consumer is taking frames right now; then
+        // it frees the whole ring in a moment
+        if (state & kBusy) {
+            std::this_thread::yield();
+            state = m_state.load(std::memory_order_acquire);
+        } else if (m_state.compare_exchange_weak(state, state + 2, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    const size_t i = head % m_slots.size();
+    // the frame a full ring just dropped still has to be handed back
+    if (m_lent[i]) {
+        m_lent[i] = 0;
+        if (m_onRelease) m_onRelease(m_slots[i]);
+    }
+    if (m_writingSpare) {
+        // the dropped frame's buffer becomes the next spare
+        cv::swap(m_slots[i].frame, m_spare.frame);
+        m_slots[i].sequence = m_spare.sequence;
+        m_slots[i].captureTimeNs = m_spare.captureTimeNs;
+        m_writingSpare = false;
+    }
+    m_lent[i] = 1;
+    m_captured.fetch_add(1, std::memory_order_relaxed);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void FrameRing::dropWrite() {
+    m_captured.fetch_add(1, std::memory_order_relaxed);
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameSlot* FrameRing::acquireLatest() {
+    if (m_holding) release();
+
+    // claim the unread slots; a producer dropping the oldest frame meanwhile makes this fail
+    uint64_t state = m_state.load(std::memory_order_relaxed);
+    while (!m_state.compare_exchange_weak(state, state | kBusy, std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {}
+    const uint64_t tail = state >> 1;
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    if (head == tail) {
+        m_state.store(tail << 1, std::memory_order_release);
+        return nullptr;
+    }
+
+    // Everything between tail and the newest frame is stale; give those frames straight back.
+    // The newest trades places with the consumer's own slot, whose frame was released already.
+    const uint64_t latest = head - 1;
+    for (uint64_t i = tail; i < latest; ++i) {
+        const size_t s = i % m_slots.size();
+        m_lent[s] = 0;
+        if (m_onRelease) m_onRelease(m_slots[s]);
+    }
+    FrameSlot& newest = m_slots[latest % m_slots.size()];
+    m_lent[latest % m_slots.size()] = 0;
+    cv::swap(m_held.frame, newest.frame);
+    m_held.sequence = newest.sequence;
+    m_held.captureTimeNs = newest.captureTimeNs;
+    m_state.store(head << 1, std::memory_order_release);
+
+    if (latest > tail) m_dropped.fetch_add(latest - tail, std::memory_order_relaxed);
+    m_holding = true;
+    m_consumed.fetch_add(1, std::memory_order_relaxed);
+    return &m_held;
+}
+
+void FrameRing::release() {
+    if (!m_holding) return;
+    m_holding = false;
+    if (m_onRelease) m_onRelease(m_held);
+}
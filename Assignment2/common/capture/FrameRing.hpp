@@ -0,0 +1,97 @@
+/*
+ * FrameRing.hpp
+ *
+ *  Bounded single-producer/single-consumer ring of preallocated frame slots.
+ *  The capture thread is the only producer, the render loop the only consumer.
+ *
+ */
+#ifndef FRAMERING_HPP
+#define FRAMERING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+//! FrameSlot
+/*! One entry of the ring. The Mat is reused between frames, so its buffer is only
+    reallocated when the frame size or type changes. */
+struct FrameSlot {
+    cv::Mat frame;              //!< frame data, owned by the ring
+    uint64_t sequence = 0;      //!< running capture index
+    int64_t captureTimeNs = 0;  //!< steady clock timestamp taken right after the read
+};
+
+//! FrameRing
+/*!
+ Lock-free SPSC ring. The producer fills the slot returned by beginWrite() and publishes it with
+ commitWrite(). The consumer only ever looks at the newest published frame: acquireLatest() skips
+ (and counts as dropped) everything older and swaps the newest out of the ring into a slot of its
+ own, which it keeps until release(). A full ring therefore never waits on the consumer: the
+ producer reads into a spare slot of its own and only drops the oldest unread frame once the new
+ one is committed, so the newest one always gets in and a failed read costs nothing. Tail and a busy flag
+ for the consumer's short swap share one atomic word. Frames may point into memory owned by the
+ source, so the consumer must not modify them in place.
+ */
+class FrameRing {
+public:
+    //! Constructor
+    /*! Capacity must be at least 2. */
+    FrameRing(size_t capacity = 4);
+
+    //! preallocate
+    /*! Allocate every slot, the consumer's included, up front so the first frames do not hit the
+        allocator. */
+    void preallocate(int width, int height, int type);
+
+    //! beginWrite
+    /*! Producer side. Returns the slot to fill: the next ring slot, or the producer's spare while
+        the ring is full. Nothing is dropped until commitWrite(). */
+    FrameSlot* beginWrite();
+    //! commitWrite
+    /*! Producer side. Publishes the slot returned by the last beginWrite(). If the ring is still
+        full, its oldest unread frame is dropped to make room. A beginWrite() that is not committed
+        (the read failed) is simply abandoned. */
+    void commitWrite();
+    //! dropWrite
+    /*! Producer side. Counts a frame that was discarded before it reached the ring. */
+    void dropWrite();
+
+    //! acquireLatest
+    /*! Consumer side, never blocks. Returns the newest unread frame or nullptr if nothing new
+        arrived. Any frame still held from a previous call is released first. */
+    FrameSlot* acquireLatest();
+    //! release
+    /*! Consumer side. Hands the slot from acquireLatest() back to the producer. */
+    void release();
+
+    //! setReleaseCallback
+    /*! Called once for every published frame when it is given up: on the consumer thread when it
+        is released or skipped, on the producer thread when a full ring drops it. Lets sources that
+        lend out their own buffers reclaim them. */
+    void setReleaseCallback(std::function<void(FrameSlot&)> callback) { m_onRelease = callback; }
+
+    uint64_t captured() const { return m_captured.load(std::memory_order_relaxed); }
+    uint64_t consumed() const { return m_consumed.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    std::vector<FrameSlot> m_slots;
+    std::vector<uint8_t> m_lent;    //!< per slot: holds a frame not yet passed to the release callback
+    std::atomic<uint64_t> m_head;   //!< next index the producer writes, only the producer stores it
+    std::atomic<uint64_t> m_state;  //!< oldest unread index << 1, | 1 while the consumer takes frames
+    FrameSlot m_held;               //!< the consumer's frame, swapped in from the ring
+    bool m_holding;
+    FrameSlot m_spare;              //!< the producer's frame while the ring is full, swapped in on commit
+    bool m_writingSpare;            //!< the last beginWrite() returned m_spare
+    std::function<void(FrameSlot&)> m_onRelease;
+
+    std::atomic<uint64_t> m_captured;
+    std::atomic<uint64_t> m_consumed;
+    std::atomic<uint64_t> m_dropped;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "FrameSource.hpp"
+#include "WebcamSource.hpp"
+#include "VideoFileSource.hpp"
+#include "SyntheticSource.hpp"
+#include "RawReplaySource.hpp"
+#include "V4L2Source.hpp"
+
+#include <cstdlib>
+
+FrameSource* FrameSource::create(const FrameSourceConfig& config) {
+    if (config.kind == "webcam")
+        return new WebcamSource(config.deviceIndex, config.width, config.height, config.fps, config.mjpg);
+    if (config.kind == "file")
+        return new VideoFileSource(config.path, config.fps);
+    if (config.kind == "synthetic")
+        return new SyntheticSource(config.width, config.height, config.fps,
+                                   config.pattern, config.redFraction, config.scatterRed,
+                                   parsePixelFormat(config.yuv));
+    if (config.kind == "v4l2")
+        return new V4L2Source(config.path, config.width, config.height, config.fps,
+                              parsePixelFormat(config.yuv));
+    if (config.kind == "raw")
+        return new RawReplaySource(config.path, config.fps);
+    return nullptr;
+}
+
+bool FrameSource::parseSpec(const std::string& spec, FrameSourceConfig& config) {
+    size_t colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::string arg = colon == std::string::npos ? "" : spec.substr(colon + 1);
+
+    if (kind == "webcam") {
+        config.kind = kind;
+        if (!arg.empty()) config.deviceIndex = std::atoi(arg.c_str());
+        return true;
+    }
+    if (kind == "v4l2") {
+        config.kind = kind;
+        config.path = arg.empty() ? "/dev/video0" : arg;
+        return true;
+    }
+    if (kind == "file" || kind == "raw") {
+        if (arg.empty()) return false;
+        config.kind = kind;
+        config.path = arg;
+        return true;
+    }
+    if (kind == "synthetic") {
+        config.kind = kind;
+        if (!arg.empty()) config.pattern = arg;
+        return SyntheticSource::isKnownPattern(config.pattern);
+    }
+    return false;
+}
+
+FramePixelFormat FrameSource::parsePixelFormat(const std::string& name) {
+    if (name == "yuyv") return FRAME_YUYV;
+    if (name == "nv12") return FRAME_NV12;
+    return FRAME_BGR24;
+}
+
+void FrameSource::toBGR(const cv::Mat& frame, FramePixelFormat format, cv::Mat& bgr) {
+    switch (format) {
+        case FRAME_YUYV: cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_YUYV); break;
+        case FRAME_NV12: cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_NV12); break;
+        default: bgr = frame; break;
+    }
+}
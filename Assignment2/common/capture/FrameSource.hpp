@@ -0,0 +1,103 @@
+/*
+ * FrameSource.hpp
+ *
+ *  Interface for anything that produces BGR frames for the pipeline: a webcam,
+ *  a V4L2 device, a video file, a raw recording or a synthetic pattern generator.
+ *
+ */
+#ifndef FRAMESOURCE_HPP
+#define FRAMESOURCE_HPP
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+//! FramePixelFormat
+/*! Layout of the frames a source hands out. */
+enum FramePixelFormat {
+    FRAME_BGR24,    //!< CV_8UC3, what the CPU filters expect
+    FRAME_YUYV,     //!< CV_8UC2 packed 4:2:2 (Y0 U Y1 V)
+    FRAME_NV12      //!< CV_8UC1 with height*3/2 rows: Y plane, then interleaved UV at half size
+};
+
+//! FrameSourceConfig
+/*! Everything needed to build a source from the command line. */
+struct FrameSourceConfig {
+    std::string kind = "webcam";        //!< webcam, v4l2, file, raw or synthetic
+    int deviceIndex = 0;                //!< webcam index
+    bool mjpg = false;                  //!< webcam: request MJPG and decode on the JpegDecodePool
+    std::string yuv;                    //!< v4l2/synthetic: hand out "yuyv" or "nv12" instead of BGR
+    std::string path;                   //!< V4L2 device, video file or raw recording path
+    std::string pattern = "gradient";   //!< synthetic pattern: gradient, checker or noise
+    float redFraction = 0.0f;           //!< synthetic: fraction of pixels that take the sinCity red branch
+    bool scatterRed = true;             //!< synthetic: scatter red pixels instead of one solid band
+    int width = 1280;
+    int height = 720;
+    double fps = 30.0;                  //!< pacing for file/raw/synthetic sources, 0 = as fast as possible
+};
+
+//!  FrameSource.
+/*!
+ Produces frames for the CaptureThread. read() is only ever called from the capture thread,
+ setResolution() is serialised with it by the CaptureThread.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+
+    //! open
+    /*! Open the device/file and apply the configured resolution. */
+    virtual bool open() = 0;
+    //! close
+    /*! Release the device/file. */
+    virtual void close() = 0;
+    //! read
+    /*! Blocking read of the next frame into frame, reusing its buffer when the size matches.
+        A source may instead point frame at memory it owns; consumers treat frames as read-only. */
+    virtual bool read(cv::Mat& frame) = 0;
+    //! setResolution
+    /*! Request a new output size. Returns false if the source cannot honour it. */
+    virtual bool setResolution(int width, int height) = 0;
+    //! resolution
+    /*! Size of the frames read() currently produces. */
+    virtual cv::Size resolution() = 0;
+    //! name
+    /*! Short description used in logs and the batch CSV. */
+    virtual std::string name() const = 0;
+    //! backendName
+    /*! Which capture backend actually produces the frames, for the batch CSV. */
+    virtual std::string backendName() const = 0;
+
+    //! holdsBuffers
+    /*! True if read() hands out views of buffers the source needs back via releaseFrame(). */
+    virtual bool holdsBuffers() const { return false; }
+    //! releaseFrame
+    /*! Called once the pipeline no longer uses a frame returned by read(). May be called from
+        a different thread than read(). */
+    virtual void releaseFrame(const cv::Mat& frame) {}
+    //! isCompressed
+    /*! True if read() returns encoded JPEG bytes (a single CV_8UC1 row) instead of BGR pixels.
+        The CaptureThread then decodes them on its JpegDecodePool. */
+    virtual bool isCompressed() const { return false; }
+
+    //! pixelFormat
+    /*! Layout of the frames read() returns. Only changes across setResolution(). */
+    virtual FramePixelFormat pixelFormat() const { return FRAME_BGR24; }
+
+    //! toBGR
+    /*! Converts a frame of the given layout to BGR. BGR frames are passed through without a copy. */
+    static void toBGR(const cv::Mat& frame, FramePixelFormat format, cv::Mat& bgr);
+    //! parsePixelFormat
+    /*! "yuyv" or "nv12"; anything else is BGR24. */
+    static FramePixelFormat parsePixelFormat(const std::string& name);
+
+    //! create
+    /*! Builds the source described by config. Returns nullptr for an unknown kind. */
+    static FrameSource* create(const FrameSourceConfig& config);
+    //! parseSpec
+    /*! Fills kind/deviceIndex/path/pattern from "webcam[:index]", "v4l2[:device]", "file:<path>",
+        "raw:<path>" or "synthetic[:pattern]". */
+    static bool parseSpec(const std::string& spec, FrameSourceConfig& config);
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "JpegDecodePool.hpp"
+
+#include <chrono>
+
+JpegDecodePool::JpegDecodePool(int threads, size_t maxInFlight, Sink sink)
+    : m_sink(sink), m_maxInFlight(maxInFlight < 1 ? 1 : maxInFlight),
+      m_nextSequence(0), m_nextDelivery(0), m_stop(false),
+      m_decoded(0), m_failed(0), m_decodeNs(0) {
+    for (int i = 0; i < threads; ++i) {
+        m_workers.emplace_back(&JpegDecodePool::worker, this);
+    }
+}
+
+JpegDecodePool::~JpegDecodePool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_jobs.clear();
+    }
+    m_jobReady.notify_all();
+    for (auto& t : m_workers) t.join();
+}
+
+double JpegDecodePool::averageDecodeMs() const {
+    uint64_t n = m_decoded.load() + m_failed.load();
+    return n > 0 ? (double)m_decodeNs.load() / 1e6 / (double)n : 0.0;
+}
+
+bool JpegDecodePool::decode(const cv::Mat& compressed, cv::Mat& frame) {
+    auto start = std::chrono::steady_clock::now();
+    cv::imdecode(compressed, cv::IMREAD_COLOR, &frame);
+    m_decodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    bool ok = !frame.empty();
+    if (ok) ++m_decoded;
+    else ++m_failed;
+    return ok;
+}
+
+bool JpegDecodePool::submit(cv::Mat&& compressed, int64_t captureTimeNs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_workers.empty()) {
+        // serial mode: decode right here on the caller's thread
+        Result& r = m_results[m_nextSequence++];
+        if (!m_spare.empty()) {
+            r.frame = m_spare.back();
+            m_spare.pop_back();
+        }
+        r.captureTimeNs = captureTimeNs;
+        r.ok = decode(compressed, r.frame);
+        deliverReady();
+        return true;
+    }
+
+    if (m_nextSequence - m_nextDelivery >= m_maxInFlight) {
+        return false;
+    }
+    m_jobs.push_back({ m_nextSequence++, std::move(compressed), captureTimeNs });
+    lock.unlock();
+    m_jobReady.notify_one();
+    return true;
+}
+
+void JpegDecodePool::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_drained.wait(lock, [this] { return m_stop || m_nextDelivery == m_nextSequence; });
+}
+
+void JpegDecodePool::worker() {
+    for (;;) {
+        Job job;
+        cv::Mat target;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_stop) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            if (!m_spare.empty()) {
+                target = m_spare.back();
+                m_spare.pop_back();
+            }
+        }
+
+        bool ok = decode(job.compressed, target);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return;
+        Result& r = m_results[job.sequence];
+        r.frame = target;
+        r.captureTimeNs = job.captureTimeNs;
+        r.ok = ok;
+        deliverReady();
+    }
+}
+
+void JpegDecodePool::deliverReady() {
+    for (auto it = m_results.find(m_nextDelivery); it != m_results.end(); it = m_results.find(m_nextDelivery)) {
+        Result& r = it->second;
+        if (r.ok) m_sink(r.frame, r.captureTimeNs);
+        if (!r.frame.empty()) m_spare.push_back(r.frame);
+        m_results.erase(it);
+        ++m_nextDelivery;
+    }
+    if (m_nextDelivery == m_nextSequence) m_drained.notify_all();
+}
@@ -0,0 +1,94 @@
+/*
+ * JpegDecodePool.hpp
+ *
+ *  Decodes compressed (MJPG) camera frames on a small pool of worker threads and
+ *  delivers the results in capture order.
+ *
+ */
+#ifndef JPEGDECODEPOOL_HPP
+#define JPEGDECODEPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+//!  JpegDecodePool.
+/*!
+ submit() queues a compressed frame and returns immediately. Workers decode with cv::imdecode into
+ recycled buffers; finished frames are handed to the sink strictly in submission order, one call
+ at a time. With zero threads, submit() decodes and delivers inline (the serial baseline).
+ */
+class JpegDecodePool {
+public:
+    //! Sink
+    /*! Receives decoded frames in order. The sink may swap the Mat with one of its own buffers;
+        whatever the Mat holds afterwards is reused as a decode target. */
+    typedef std::function<void(cv::Mat& frame, int64_t captureTimeNs)> Sink;
+
+    //! Constructor
+    /*! maxInFlight bounds the frames queued or being decoded; further submits are rejected. */
+    JpegDecodePool(int threads, size_t maxInFlight, Sink sink);
+    //! Destructor
+    /*! Discards queued frames and joins the workers. */
+    ~JpegDecodePool();
+
+    //! submit
+    /*! Takes ownership of the compressed data. Returns false if too many frames are in flight. */
+    bool submit(cv::Mat&& compressed, int64_t captureTimeNs);
+    //! flush
+    /*! Blocks until every submitted frame has been delivered or discarded. */
+    void flush();
+
+    int threads() const { return (int)m_workers.size(); }
+    uint64_t decoded() const { return m_decoded.load(); }
+    uint64_t failed() const { return m_failed.load(); }
+    //! averageDecodeMs
+    /*! Mean time spent in cv::imdecode per frame. */
+    double averageDecodeMs() const;
+
+private:
+    struct Job {
+        uint64_t sequence;
+        cv::Mat compressed;
+        int64_t captureTimeNs;
+    };
+    struct Result {
+        cv::Mat frame;
+        int64_t captureTimeNs;
+        bool ok;
+    };
+
+    void worker();
+    bool decode(const cv::Mat& compressed, cv::Mat& frame);
+    //! deliverReady
+    /*! Hands every consecutive finished frame to the sink. Caller holds m_mutex. */
+    void deliverReady();
+
+    Sink m_sink;
+    size_t m_maxInFlight;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_drained;
+    std::deque<Job> m_jobs;
+    std::map<uint64_t, Result> m_results;   //!< finished but not yet deliverable
+    std::vector<cv::Mat> m_spare;           //!< recycled decode targets
+    uint64_t m_nextSequence;
+    uint64_t m_nextDelivery;
+    bool m_stop;
+
+    std::atomic<uint64_t> m_decoded;
+    std::atomic<uint64_t> m_failed;
+    std::atomic<int64_t> m_decodeNs;
+};
+
+#endif
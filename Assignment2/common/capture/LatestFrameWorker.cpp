@@ -0,0 +1,72 @@
+#include "LatestFrameWorker.hpp"
+
+#include <chrono>
+
+LatestFrameWorker::LatestFrameWorker(CaptureThread& capture, Process process)
+    : m_capture(capture), m_process(process), m_running(false),
+      m_front(0), m_back(1), m_middle(2), m_processed(0), m_superseded(0) {}
+
+LatestFrameWorker::~LatestFrameWorker() {
+    stop();
+}
+
+void LatestFrameWorker::start() {
+    if (m_running.load()) return;
+    for (ProcessedFrame& f : m_frames) f.image.release();
+    m_front = 0;
+    m_back = 1;
+    m_middle = 2;
+    m_processed = 0;
+    m_superseded = 0;
+
+    m_running = true;
+    m_thread = std::thread(&LatestFrameWorker::run, this);
+}
+
+void LatestFrameWorker::stop() {
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool LatestFrameWorker::fetchLatest() {
+    if (!(m_middle.load(std::memory_order_relaxed) & kFresh)) return false;
+    // hand our buffer over and take the fresh one; acquire makes its contents visible
+    int prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = prev & ~kFresh;
+    return true;
+}
+
+WorkerStats LatestFrameWorker::stats() const {
+    WorkerStats s;
+    s.processed = m_processed.load();
+    s.superseded = m_superseded.load();
+    return s;
+}
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatestFrameWorker::run() {
+    while (m_running.load()) {
+        FrameSlot* slot = m_capture.acquireLatest();
+        if (!slot) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        ProcessedFrame& out = m_frames[m_back];
+        m_process(slot->frame, out.image);
+        out.sequence = slot->sequence;
+        out.captureTimeNs = slot->captureTimeNs;
+        m_capture.release();
+        out.doneTimeNs = steadyNowNs();
+        ++m_processed;
+
+        // publish; if the display never took the previous result it is superseded
+        int prev = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        if (prev & kFresh) ++m_superseded;
+        m_back = prev & ~kFresh;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * LatestFrameWorker.hpp
+ *
+ *  Runs a processing step on its own thread, always on the newest captured frame,
+ *  and hands the newest finished result to the display loop.
+ *
+ */
+#ifndef LATESTFRAMEWORKER_HPP
+#define LATESTFRAMEWORKER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "CaptureThread.hpp"
+
+//! ProcessedFrame
+/*! One result of the worker. */
+struct ProcessedFrame {
+    cv::Mat image;              //!< output of the processing step
+    uint64_t sequence = 0;      //!< capture sequence of the input frame
+    int64_t captureTimeNs = 0;  //!< capture timestamp of the input frame (steady clock)
+    int64_t doneTimeNs = 0;     //!< when processing finished
+};
+
+//! WorkerStats
+/*! Counters since start(). */
+struct WorkerStats {
+    uint64_t processed = 0;     //!< results produced
+    uint64_t superseded = 0;    //!< results replaced by a newer one before the display picked them up
+};
+
+//!  LatestFrameWorker.
+/*!
+ Latest-frame-wins scheduling: while running, the worker is the CaptureThread's consumer. Each
+ iteration takes the newest frame (older ones are dropped by the ring), processes it and publishes
+ the result through a lock-free triple buffer. The display loop calls fetchLatest() at its own rate
+ and never waits for processing, so a slow filter lowers the processing rate but not the display rate
+ and never lets stale frames queue up. While the worker runs, nobody else may call
+ acquireLatest()/release() on the CaptureThread.
+ */
+class LatestFrameWorker {
+public:
+    //! Process
+    /*! Turns a captured frame into a result. out is reused between calls. */
+    typedef std::function<void(cv::Mat& frame, cv::Mat& out)> Process;
+
+    LatestFrameWorker(CaptureThread& capture, Process process);
+    ~LatestFrameWorker();
+
+    //! start
+    /*! Starts consuming frames. Results from an earlier run are discarded. */
+    void start();
+    //! stop
+    /*! Joins the worker; afterwards the calling thread may consume from the CaptureThread again. */
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    //! fetchLatest
+    /*! Display side. Returns true if a newer result replaced the one in latest(). Never blocks. */
+    bool fetchLatest();
+    //! latest
+    /*! Most recent result taken by fetchLatest(). Empty image until the first one arrives. */
+    const ProcessedFrame& latest() const { return m_frames[m_front]; }
+
+    WorkerStats stats() const;
+
+private:
+    void run();
+
+    static const int kFresh = 4;    //!< set in m_middle while it holds an unseen result
+
+    CaptureThread& m_capture;
+    Process m_process;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    ProcessedFrame m_frames[3];     //!< triple buffer
+    int m_front;                    //!< owned by the display loop
+    int m_back;                     //!< owned by the worker
+    std::atomic<int> m_middle;      //!< index of the handover buffer | kFresh
+
+    std::atomic<uint64_t> m_processed;
+    std::atomic<uint64_t> m_superseded;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "RawFrameFile.hpp"
+
+#include <cstring>
+#include <iostream>
+
+static const char kRawMagic[8] = { 'V', 'C', 'R', 'A', 'W', 'F', 'R', 'M' };
+
+static uint64_t roundUpToPage(uint64_t bytes) {
+    return (bytes + kRawPageSize - 1) / kRawPageSize * kRawPageSize;
+}
+
+RawPixelFormat rawFormatFromType(int cvType) {
+    switch (cvType) {
+        case CV_8UC3: return RAW_FORMAT_BGR24;
+        case CV_8UC1: return RAW_FORMAT_GRAY8;
+        case CV_8UC2: return RAW_FORMAT_YUYV;
+        default: return RAW_FORMAT_UNKNOWN;
+    }
+}
+
+int cvTypeFromRawFormat(RawPixelFormat format) {
+    switch (format) {
+        case RAW_FORMAT_BGR24: return CV_8UC3;
+        case RAW_FORMAT_GRAY8: return CV_8UC1;
+        case RAW_FORMAT_YUYV: return CV_8UC2;
+        default: return -1;
+    }
+}
+
+// -- Writer --
+
+RawFrameWriter::RawFrameWriter() : m_file(nullptr), m_firstTimeNs(0), m_skipped(0) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+RawFrameWriter::~RawFrameWriter() {
+    close();
+}
+
+bool RawFrameWriter::open(const std::string& path) {
+    close();
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "[RAW] Cannot open " << path << " for writing\n";
+        return false;
+    }
+
+    memset(&m_header, 0, sizeof(m_header));
+    memcpy(m_header.magic, kRawMagic, sizeof(kRawMagic));
+    m_header.version = kRawVersion;
+    m_header.headerSize = kRawPageSize;
+    m_timestamps.clear();
+    m_skipped = 0;
+
+    // placeholder header page, rewritten by close()
+    std::vector<unsigned char> page(kRawPageSize, 0);
+    fwrite(page.data(), 1, page.size(), m_file);
+    return true;
+}
+
+bool RawFrameWriter::append(const cv::Mat& frame, int64_t captureTimeNs) {
+    if (!m_file || frame.empty()) return false;
+
+    if (m_header.frameCount == 0) {
+        RawPixelFormat format = rawFormatFromType(frame.type());
+        if (format == RAW_FORMAT_UNKNOWN) {
+            ++m_skipped;
+            return false;
+        }
+        m_header.width = (uint32_t)frame.cols;
+        m_header.height = (uint32_t)frame.rows;
+        m_header.stride = (uint32_t)(frame.cols * frame.elemSize());
+        m_header.pixelFormat = format;
+        m_header.frameBytes = (uint64_t)m_header.stride * m_header.height;
+        m_header.frameStride = roundUpToPage(m_header.frameBytes);
+        m_padding.assign((size_t)(m_header.frameStride - m_header.frameBytes), 0);
+        m_firstTimeNs = captureTimeNs;
+    }
+    else if ((uint32_t)frame.cols != m_header.width || (uint32_t)frame.rows != m_header.height ||
+             rawFormatFromType(frame.type()) != (RawPixelFormat)m_header.pixelFormat) {
+        ++m_skipped;
+        return false;
+    }
+
+    if (frame.isContinuous()) {
+        fwrite(frame.data, 1, (size_t)m_header.frameBytes, m_file);
+    } else {
+        for (int y = 0; y < frame.rows; ++y)
+            fwrite(frame.ptr(y), 1, m_header.stride, m_file);
+    }
+    if (!m_padding.empty()) fwrite(m_padding.data(), 1, m_padding.size(), m_file);
+
+    m_timestamps.push_back(captureTimeNs - m_firstTimeNs);
+    ++m_header.frameCount;
+    return true;
+}
+
+void RawFrameWriter::close() {
+    if (!m_file) return;
+
+    m_header.indexOffset = m_header.headerSize + m_header.frameStride * m_header.frameCount;
+    if (!m_timestamps.empty())
+        fwrite(m_timestamps.data(), sizeof(int64_t), m_timestamps.size(), m_file);
+
+    fseek(m_file, 0, SEEK_SET);
+    fwrite(&m_header, sizeof(m_header), 1, m_file);
+    fclose(m_file);
+    m_file = nullptr;
+
+    std::cout << "[RAW] Recorded " << m_header.frameCount << " frames";
+    if (m_skipped) std::cout << " (" << m_skipped << " skipped: size or format changed)";
+    std::cout << "\n";
+}
+
+// -- Reader --
+
+RawFrameReader::RawFrameReader() : m_timestamps(nullptr) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+bool RawFrameReader::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) {
+        std::cerr << "[RAW] Cannot map " << path << "\n";
+        return false;
+    }
+
+    const size_t fileSize = m_file.size();
+    if (fileSize < sizeof(RawFileHeader)) {
+        std::cerr << "[RAW] " << path << " is too small to be a raw frame file\n";
+        close();
+        return false;
+    }
+    memcpy(&m_header, m_file.data(), sizeof(m_header));
+
+    bool valid = memcmp(m_header.magic, kRawMagic, sizeof(kRawMagic)) == 0
+        && m_header.version == kRawVersion
+        && m_header.headerSize % kRawPageSize == 0
+        && cvTypeFromRawFormat((RawPixelFormat)m_header.pixelFormat) >= 0
+        && m_header.frameBytes == (uint64_t)m_header.stride * m_header.height
+        && m_header.frameStride >= m_header.frameBytes
+        && m_header.frameStride % kRawPageSize == 0
+        && m_header.indexOffset == m_header.headerSize + m_header.frameStride * m_header.frameCount
+        && m_header.indexOffset + m_header.frameCount * sizeof(int64_t) <= fileSize;
+    if (!valid || m_header.frameCount == 0) {
+        std::cerr << "[RAW] " << path << " has an invalid header or no frames\n";
+        close();
+        return false;
+    }
+
+    m_timestamps = (const int64_t*)(m_file.data() + m_header.indexOffset);
+    m_file.prefetch();
+    return true;
+}
+
+void RawFrameReader::close() {
+    m_file.close();
+    memset(&m_header, 0, sizeof(m_header));
+    m_timestamps = nullptr;
+}
+
+cv::Mat RawFrameReader::frame(size_t index) const {
+    if (index >= frameCount()) return cv::Mat();
+    // cv::Mat wants a non-const pointer; the pages themselves are mapped read-only
+    unsigned char* data = m_file.data() + m_header.headerSize + m_header.frameStride * index;
+    return cv::Mat((int)m_header.height, (int)m_header.width,
+                   cvTypeFromRawFormat((RawPixelFormat)m_header.pixelFormat), data, m_header.stride);
+}
+
+int64_t RawFrameReader::timestampNs(size_t index) const {
+    return index < frameCount() ? m_timestamps[index] : 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * RawFrameFile.hpp
+ *
+ *  Uncompressed frame container for record/replay benchmarking.
+ *
+ *  Layout (little endian):
+ *    [RawFileHeader, zero padded to kRawPageSize]
+ *    [frame 0, padded to a multiple of kRawPageSize]
+ *    [frame 1, ...]
+ *    [int64 timestamp per frame, nanoseconds since the first frame]
+ *
+ *  Frames start on page boundaries, so a mapping of the file hands out page aligned
+ *  frame pointers that can be wrapped in cv::Mat headers without copying.
+ *
+ */
+#ifndef RAWFRAMEFILE_HPP
+#define RAWFRAMEFILE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <common/MappedFile.hpp>
+
+static const uint32_t kRawPageSize = 4096;
+static const uint32_t kRawVersion = 1;
+
+//! RawPixelFormat
+/*! Pixel layout of the stored frames. */
+enum RawPixelFormat : uint32_t {
+    RAW_FORMAT_UNKNOWN = 0,
+    RAW_FORMAT_BGR24 = 1,   //!< CV_8UC3
+    RAW_FORMAT_GRAY8 = 2,   //!< CV_8UC1
+    RAW_FORMAT_YUYV = 3     //!< CV_8UC2, packed 4:2:2
+};
+
+//! RawFileHeader
+/*! Fixed size header at offset 0. */
+struct RawFileHeader {
+    char magic[8];          //!< "VCRAWFRM"
+    uint32_t version;
+    uint32_t headerSize;    //!< offset of the first frame
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;        //!< bytes per row inside a frame
+    uint32_t pixelFormat;   //!< RawPixelFormat
+    uint64_t frameBytes;    //!< stride * height
+    uint64_t frameStride;   //!< distance between frames, frameBytes rounded up to kRawPageSize
+    uint64_t frameCount;
+    uint64_t indexOffset;   //!< offset of the timestamp table
+};
+
+RawPixelFormat rawFormatFromType(int cvType);
+int cvTypeFromRawFormat(RawPixelFormat format);
+
+//!  RawFrameWriter.
+/*!
+ Appends frames to a raw container. All frames must have the size and type of the first one;
+ others are skipped and counted. The header and timestamp table are written by close().
+ */
+class RawFrameWriter {
+public:
+    RawFrameWriter();
+    ~RawFrameWriter();
+
+    bool open(const std::string& path);
+    //! append
+    /*! captureTimeNs is any monotonic timestamp; it is stored relative to the first frame. */
+    bool append(const cv::Mat& frame, int64_t captureTimeNs);
+    //! close
+    /*! Writes the timestamp table and the final header. */
+    void close();
+
+    bool isOpen() const { return m_file != nullptr; }
+    uint64_t framesWritten() const { return m_header.frameCount; }
+    uint64_t framesSkipped() const { return m_skipped; }
+
+private:
+    FILE* m_file;
+    RawFileHeader m_header;
+    std::vector<int64_t> m_timestamps;
+    std::vector<unsigned char> m_padding;
+    int64_t m_firstTimeNs;
+    uint64_t m_skipped;
+};
+
+//!  RawFrameReader.
+/*!
+ Maps a raw container read-only and hands out cv::Mat headers that point straight into the
+ mapping. Writing into a frame faults, so consumers must treat frames as read-only.
+ */
+class RawFrameReader {
+public:
+    RawFrameReader();
+
+    //! open
+    /*! Map and validate the file. */
+    bool open(const std::string& path);
+    void close();
+
+    //! frame
+    /*! Header for frame index; no pixel data is copied. Valid while the reader is open. */
+    cv::Mat frame(size_t index) const;
+    //! timestampNs
+    /*! Capture time of frame index relative to the first frame. */
+    int64_t timestampNs(size_t index) const;
+
+    size_t frameCount() const { return (size_t)m_header.frameCount; }
+    int width() const { return (int)m_header.width; }
+    int height() const { return (int)m_header.height; }
+    RawPixelFormat pixelFormat() const { return (RawPixelFormat)m_header.pixelFormat; }
+
+private:
+    MappedFile m_file;
+    RawFileHeader m_header;
+    const int64_t* m_timestamps;
+};
+
+#endif
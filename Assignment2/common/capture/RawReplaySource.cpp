@@ -0,0 +1,58 @@
+#include "RawReplaySource.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+RawReplaySource::RawReplaySource(const std::string& path, double fps)
+    : m_path(path), m_fps(fps), m_index(0) {}
+
+bool RawReplaySource::open() {
+    if (!m_reader.open(m_path)) return false;
+    std::cout << "[RAW] Replaying " << m_reader.frameCount() << " frames of "
+              << m_reader.width() << "x" << m_reader.height() << " from " << m_path << "\n";
+    m_index = 0;
+    m_nextFrame = std::chrono::steady_clock::now();
+    return true;
+}
+
+void RawReplaySource::close() {
+    m_reader.close();
+}
+
+bool RawReplaySource::read(cv::Mat& frame) {
+    if (m_fps > 0.0) {
+        std::this_thread::sleep_until(m_nextFrame);
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / m_fps));
+        m_nextFrame = std::max(m_nextFrame + period, std::chrono::steady_clock::now());
+    }
+
+    // GRAY8 has no FramePixelFormat of its own, so it is expanded to BGR (a copy, unlike the rest)
+    if (m_reader.pixelFormat() == RAW_FORMAT_GRAY8)
+        cv::cvtColor(m_reader.frame(m_index), frame, cv::COLOR_GRAY2BGR);
+    else
+        frame = m_reader.frame(m_index);
+    m_index = (m_index + 1) % m_reader.frameCount();
+    return !frame.empty();
+}
+
+bool RawReplaySource::setResolution(int width, int height) {
+    return width == m_reader.width() && height == m_reader.height();
+}
+
+cv::Size RawReplaySource::resolution() {
+    return cv::Size(m_reader.width(), m_reader.height());
+}
+
+std::string RawReplaySource::name() const {
+    return "raw:" + m_path;
+}
+
+std::string RawReplaySource::backendName() const {
+    return "raw-mmap";
+}
+
+FramePixelFormat RawReplaySource::pixelFormat() const {
+    return m_reader.pixelFormat() == RAW_FORMAT_YUYV ? FRAME_YUYV : FRAME_BGR24;
+}
@@ -0,0 +1,45 @@
+/*
+ * RawReplaySource.hpp
+ *
+ *  FrameSource that replays a RawFrameFile straight out of a memory mapping.
+ *
+ */
+#ifndef RAWREPLAYSOURCE_HPP
+#define RAWREPLAYSOURCE_HPP
+
+#include <chrono>
+
+#include "FrameSource.hpp"
+#include "RawFrameFile.hpp"
+
+//!  RawReplaySource.
+/*!
+ read() points the target Mat at the mapped frame instead of copying into it, so replay costs
+ neither decoding nor a memcpy. The frames are read-only; the pipeline must not modify them in place.
+ GRAY8 recordings are the exception: they are converted into the target Mat and reported as BGR24.
+ Replays loop, and resolution changes are only accepted if they match the recording.
+ */
+class RawReplaySource : public FrameSource {
+public:
+    //! Constructor
+    /*! fps paces the replay; 0 replays as fast as the pipeline consumes frames. */
+    RawReplaySource(const std::string& path, double fps);
+
+    bool open();
+    void close();
+    bool read(cv::Mat& frame);
+    bool setResolution(int width, int height);
+    cv::Size resolution();
+    std::string name() const;
+    std::string backendName() const;
+    FramePixelFormat pixelFormat() const;
+
+private:
+    RawFrameReader m_reader;
+    std::string m_path;
+    double m_fps;
+    size_t m_index;
+    std::chrono::steady_clock::time_point m_nextFrame;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "SyntheticSource.hpp"
+
+#include <algorithm>
+#include <thread>
+
+// The base pattern is this many pixels wider than the frame and scrolls across it.
+static const int kScrollPeriod = 256;
+static const int kScrollStep = 4;
+// BGR red that passes the sinCity test (R > 150, R > 1.3 G, R > 1.3 B)
+static const cv::Scalar kRed(40, 40, 220);
+
+SyntheticSource::SyntheticSource(int width, int height, double fps, const std::string& pattern,
+                                 float redFraction, bool scatterRed, FramePixelFormat output)
+    : m_width(width), m_height(height), m_fps(fps), m_pattern(pattern), m_scatterRed(scatterRed),
+      m_output(output),
+      m_redFraction(redFraction), m_builtFraction(-1.0f), m_frameIndex(0) {}
+
+bool SyntheticSource::isKnownPattern(const std::string& pattern) {
+    return pattern == "gradient" || pattern == "checker" || pattern == "noise";
+}
+
+bool SyntheticSource::open() {
+    if (!isKnownPattern(m_pattern)) return false;
+    if (m_output != FRAME_BGR24 && ((m_width | m_height) & 1)) return false;
+    rebuild();
+    m_frameIndex = 0;
+    m_nextFrame = std::chrono::steady_clock::now();
+    return true;
+}
+
+void SyntheticSource::close() {
+    m_base.release();
+    m_redMask.release();
+}
+
+void SyntheticSource::rebuild() {
+    const int baseW = m_width + kScrollPeriod;
+    m_base.create(m_height, baseW, CV_8UC3);
+
+    // Every base pixel keeps R <= G, so it never takes the red branch.
+    cv::RNG rng(0x5EED);
+    for (int y = 0; y < m_height; ++y) {
+        cv::Vec3b* row = m_base.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < baseW; ++x) {
+            uchar b, g, r;
+            if (m_pattern == "checker") {
+                uchar v = (((x / 32) + (y / 32)) & 1) ? 190 : 60;
+                b = g = r = v;
+            } else if (m_pattern == "noise") {
+                b = (uchar)rng.uniform(0, 256);
+                g = (uchar)rng.uniform(0, 256);
+                r = std::min((uchar)rng.uniform(0, 256), g);
+            } else {
+                b = (uchar)(x * 255 / (baseW - 1));
+                g = (uchar)(y * 255 / std::max(1, m_height - 1));
+                r = std::min((uchar)((b + g) / 2), g);
+            }
+            row[x] = cv::Vec3b(b, g, r);
+        }
+    }
+
+    float fraction = std::min(1.0f, std::max(0.0f, m_redFraction.load()));
+    m_redMask.create(m_height, m_width, CV_8UC1);
+    cv::RNG maskRng(0xC0FFEE);
+    int bandW = (int)(fraction * m_width + 0.5f);
+    for (int y = 0; y < m_height; ++y) {
+        uchar* row = m_redMask.ptr<uchar>(y);
+        for (int x = 0; x < m_width; ++x) {
+            bool red = m_scatterRed ? maskRng.uniform(0.0f, 1.0f) < fraction : x < bandW;
+            row[x] = red ? 255 : 0;
+        }
+    }
+    m_builtFraction = m_redFraction.load();
+}
+
+bool SyntheticSource::read(cv::Mat& frame) {
+    if (m_fps > 0.0) {
+        std::this_thread::sleep_until(m_nextFrame);
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / m_fps));
+        m_nextFrame = std::max(m_nextFrame + period, std::chrono::steady_clock::now());
+    }
+
+    if (m_base.empty() || m_builtFraction != m_redFraction.load()) rebuild();
+
+    int offset = (int)((m_frameIndex * kScrollStep) % kScrollPeriod);
+    cv::Mat& target = m_output == FRAME_BGR24 ? frame : m_bgr;
+    m_base(cv::Rect(offset, 0, m_width, m_height)).copyTo(target);
+    target.setTo(kRed, m_redMask);
+    if (m_output != FRAME_BGR24) convertOutput(frame);
+    ++m_frameIndex;
+    return true;
+}
+
+void SyntheticSource::convertOutput(cv::Mat& frame) {
+    // OpenCV has no BGR -> NV12/YUYV conversion, so go through I420 and repack the chroma.
+    cv::cvtColor(m_bgr, m_i420, cv::COLOR_BGR2YUV_I420);
+    const int w = m_width, h = m_height, cw = w / 2, ch = h / 2;
+    const uchar* yPlane = m_i420.ptr<uchar>(0);
+    const uchar* uPlane = yPlane + (size_t)w * h;
+    const uchar* vPlane = uPlane + (size_t)cw * ch;
+
+    if (m_output == FRAME_NV12) {
+        frame.create(h * 3 / 2, w, CV_8UC1);
+        m_i420.rowRange(0, h).copyTo(frame.rowRange(0, h));
+        for (int y = 0; y < ch; ++y) {
+            uchar* uv = frame.ptr<uchar>(h + y);
+            for (int x = 0; x < cw; ++x) {
+                uv[2 * x] = uPlane[y * cw + x];
+                uv[2 * x + 1] = vPlane[y * cw + x];
+            }
+        }
+        return;
+    }
+
+    // YUYV: 4:2:0 chroma repeated on both rows of each pair
+    frame.create(h, w, CV_8UC2);
+    for (int y = 0; y < h; ++y) {
+        const uchar* luma = yPlane + (size_t)y * w;
+        const uchar* u = uPlane + (size_t)(y / 2) * cw;
+        const uchar* v = vPlane + (size_t)(y / 2) * cw;
+        uchar* out = frame.ptr<uchar>(y);
+        for (int x = 0; x < cw; ++x) {
+            out[4 * x] = luma[2 * x];
+            out[4 * x + 1] = u[x];
+            out[4 * x + 2] = luma[2 * x + 1];
+            out[4 * x + 3] = v[x];
+        }
+    }
+}
+
+bool SyntheticSource::setResolution(int width, int height) {
+    if (width <= 0 || height <= 0) return false;
+    // 4:2:x chroma needs even sizes
+    if (m_output != FRAME_BGR24 && ((width | height) & 1)) return false;
+    m_width = width;
+    m_height = height;
+    rebuild();
+    return true;
+}
+
+cv::Size SyntheticSource::resolution() {
+    return cv::Size(m_width, m_height);
+}
+
+void SyntheticSource::setRedFraction(float fraction) {
+    m_redFraction = fraction;
+}
+
+std::string SyntheticSource::name() const {
+    return "synthetic:" + m_pattern;
+}
+
+std::string SyntheticSource::backendName() const {
+    switch (m_output) {
+        case FRAME_YUYV: return "synthetic-yuyv";
+        case FRAME_NV12: return "synthetic-nv12";
+        default: return "synthetic";
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * SyntheticSource.hpp
+ *
+ *  Deterministic pattern generator, so benchmarks can run without a camera and
+ *  produce the same frames on every machine.
+ *
+ */
+#ifndef SYNTHETICSOURCE_HPP
+#define SYNTHETICSOURCE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "FrameSource.hpp"
+
+//!  SyntheticSource.
+/*!
+ Generates a scrolling base pattern (gradient, checker or noise) in which no pixel passes the
+ sinCity red test, then paints a controlled fraction of pixels in a red that always passes it.
+ That fraction decides how much work the red branch of CPUFilters::sinCity does.
+ With a YUYV or NV12 output format the frame is converted (BT.601, limited range) before it is
+ handed out, to stand in for a camera that delivers YUV.
+ */
+class SyntheticSource : public FrameSource {
+public:
+    //! Constructor
+    /*! fps paces the frames like a camera; 0 generates as fast as possible. */
+    SyntheticSource(int width, int height, double fps, const std::string& pattern,
+                    float redFraction = 0.0f, bool scatterRed = true,
+                    FramePixelFormat output = FRAME_BGR24);
+
+    bool open();
+    void close();
+    bool read(cv::Mat& frame);
+    bool setResolution(int width, int height);
+    cv::Size resolution();
+    std::string name() const;
+    std::string backendName() const;
+    FramePixelFormat pixelFormat() const { return m_output; }
+
+    //! setRedFraction
+    /*! Safe to call from any thread, takes effect on the next frame. */
+    void setRedFraction(float fraction);
+    float redFraction() const { return m_redFraction.load(); }
+
+    static bool isKnownPattern(const std::string& pattern);
+
+private:
+    //! rebuild
+    /*! Regenerates the base pattern and the red mask for the current size and fraction. */
+    void rebuild();
+    //! convertOutput
+    /*! Turns the BGR frame in m_bgr into the output layout. */
+    void convertOutput(cv::Mat& frame);
+
+    int m_width;
+    int m_height;
+    double m_fps;
+    std::string m_pattern;
+    bool m_scatterRed;
+    FramePixelFormat m_output;
+    std::atomic<float> m_redFraction;
+    float m_builtFraction;          //!< fraction the current mask was built for, -1 forces a rebuild
+
+    cv::Mat m_base;                 //!< pattern, wider than the frame so it can scroll
+    cv::Mat m_redMask;              //!< 8-bit mask of the pixels painted red
+    cv::Mat m_bgr;                  //!< frame before conversion, YUV output only
+    cv::Mat m_i420;                 //!< planar 4:2:0 intermediate, YUV output only
+    uint64_t m_frameIndex;
+    std::chrono::steady_clock::time_point m_nextFrame;
+};
+
+#endif
@@ -0,0 +1,309 @@
+#include "V4L2Source.hpp"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <unistd.h>
+#endif
+
+// Enough buffers for the ring (4 slots), one being captured and a couple in flight in the driver.
+static const unsigned int kBufferCount = 8;
+
+V4L2Source::V4L2Source(const std::string& device, int width, int height, double fps,
+                       FramePixelFormat output)
+    : m_device(device), m_fd(-1), m_width(width), m_height(height), m_bytesPerLine(0), m_fps(fps),
+      m_requestedFormat(output), m_outputFormat(FRAME_BGR24), m_pixelFormat(0),
+      m_zeroCopy(false), m_streaming(false), m_backend("v4l2-mmap") {}
+
+V4L2Source::~V4L2Source() {
+    close();
+}
+
+cv::Size V4L2Source::resolution() {
+    return cv::Size(m_width, m_height);
+}
+
+std::string V4L2Source::name() const {
+    return "v4l2:" + m_device;
+}
+
+std::string V4L2Source::backendName() const {
+    return m_backend;
+}
+
+#ifdef __linux__
+
+// ioctl that retries when interrupted by a signal
+static int xioctl(int fd, unsigned long request, void* arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+bool V4L2Source::open() {
+    m_fd = ::open(m_device.c_str(), O_RDWR | O_NONBLOCK);
+    if (m_fd < 0) {
+        std::cerr << "[V4L2] Cannot open " << m_device << ": " << strerror(errno) << "\n";
+        return false;
+    }
+
+    v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (xioctl(m_fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        std::cerr << "[V4L2] " << m_device << " is not a V4L2 device\n";
+        close();
+        return false;
+    }
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+        std::cerr << "[V4L2] " << m_device << " does not support streaming video capture\n";
+        close();
+        return false;
+    }
+    std::cout << "[V4L2] " << m_device << ": " << (const char*)cap.card << " (" << (const char*)cap.driver << ")\n";
+
+    if (!startStreaming()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void V4L2Source::close() {
+    stopStreaming();
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+}
+
+bool V4L2Source::startStreaming() {
+    // Prefer whatever can go to the pipeline untouched: the requested YUV layout, else BGR24.
+    // Anything else that is offered gets converted to BGR in read().
+    std::vector<uint32_t> formats;
+    if (m_requestedFormat == FRAME_NV12) formats = { V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_BGR24 };
+    else if (m_requestedFormat == FRAME_YUYV) formats = { V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_BGR24 };
+    else formats = { V4L2_PIX_FMT_BGR24, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_NV12 };
+
+    v4l2_format fmt;
+    bool negotiated = false;
+    for (uint32_t format : formats) {
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = m_width;
+        fmt.fmt.pix.height = m_height;
+        fmt.fmt.pix.pixelformat = format;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(m_fd, VIDIOC_S_FMT, &fmt) == 0 && fmt.fmt.pix.pixelformat == format) {
+            negotiated = true;
+            break;
+        }
+    }
+    if (!negotiated) {
+        std::cerr << "[V4L2] " << m_device << " offers none of BGR24, YUYV or NV12\n";
+        return false;
+    }
+    m_width = (int)fmt.fmt.pix.width;
+    m_height = (int)fmt.fmt.pix.height;
+    m_bytesPerLine = (int)fmt.fmt.pix.bytesperline;
+    m_pixelFormat = fmt.fmt.pix.pixelformat;
+
+    // a YUV layout is passed through as-is whenever the caller asked for YUV at all
+    bool yuvWanted = m_requestedFormat != FRAME_BGR24;
+    if (m_pixelFormat == V4L2_PIX_FMT_YUYV && yuvWanted) m_outputFormat = FRAME_YUYV;
+    else if (m_pixelFormat == V4L2_PIX_FMT_NV12 && yuvWanted) m_outputFormat = FRAME_NV12;
+    else m_outputFormat = FRAME_BGR24;
+    m_zeroCopy = m_pixelFormat == V4L2_PIX_FMT_BGR24 || m_outputFormat != FRAME_BGR24;
+
+    const char* captured = m_pixelFormat == V4L2_PIX_FMT_BGR24 ? "bgr24" :
+                           (m_pixelFormat == V4L2_PIX_FMT_YUYV ? "yuyv" : "nv12");
+    m_backend = std::string("v4l2-mmap-") + captured + (m_outputFormat != FRAME_BGR24 ? "-raw" : "");
+
+    if (m_fps > 0.0) {
+        v4l2_streamparm parm;
+        memset(&parm, 0, sizeof(parm));
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parm.parm.capture.timeperframe.numerator = 1000;
+        parm.parm.capture.timeperframe.denominator = (uint32_t)(m_fps * 1000.0);
+        xioctl(m_fd, VIDIOC_S_PARM, &parm);    // best effort, not every driver supports it
+    }
+
+    v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = kBufferCount;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(m_fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        std::cerr << "[V4L2] VIDIOC_REQBUFS failed: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    m_buffers.assign(req.count, Buffer());
+    for (unsigned int i = 0; i < req.count; ++i) {
+        v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(m_fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            std::cerr << "[V4L2] VIDIOC_QUERYBUF failed: " << strerror(errno) << "\n";
+            stopStreaming();
+            return false;
+        }
+        void* start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, buf.m.offset);
+        if (start == MAP_FAILED) {
+            std::cerr << "[V4L2] mmap failed: " << strerror(errno) << "\n";
+            stopStreaming();
+            return false;
+        }
+        m_buffers[i].start = (unsigned char*)start;
+        m_buffers[i].length = buf.length;
+    }
+
+    for (unsigned int i = 0; i < m_buffers.size(); ++i) {
+        if (!queueBuffer((int)i)) {
+            stopStreaming();
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(m_fd, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "[V4L2] VIDIOC_STREAMON failed: " << strerror(errno) << "\n";
+        stopStreaming();
+        return false;
+    }
+    m_streaming = true;
+
+    std::cout << "[V4L2] Streaming " << m_width << "x" << m_height << " "
+              << m_backend << (m_zeroCopy ? " (zero-copy)" : "") << " with " << m_buffers.size() << " buffers\n";
+    return true;
+}
+
+void V4L2Source::stopStreaming() {
+    if (m_fd < 0) return;
+    if (m_streaming) {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+        m_streaming = false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    for (auto& b : m_buffers) {
+        if (b.start) munmap(b.start, b.length);
+    }
+    m_buffers.clear();
+
+    v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = 0;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(m_fd, VIDIOC_REQBUFS, &req);
+}
+
+bool V4L2Source::queueBuffer(int index) {
+    v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = (unsigned int)index;
+    if (xioctl(m_fd, VIDIOC_QBUF, &buf) < 0) {
+        std::cerr << "[V4L2] VIDIOC_QBUF failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    m_buffers[index].queued = true;
+    return true;
+}
+
+bool V4L2Source::read(cv::Mat& frame) {
+    if (!m_streaming) return false;
+
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(m_fd, &fds);
+    timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    int r = select(m_fd + 1, &fds, nullptr, nullptr, &timeout);
+    if (r <= 0) return false;  // timeout, or every buffer is held by the pipeline
+
+    v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(m_fd, VIDIOC_DQBUF, &buf) < 0) return false;
+
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    Buffer& b = m_buffers[buf.index];
+    b.queued = false;
+    if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+        queueBuffer((int)buf.index);
+        return false;
+    }
+
+    // NV12 is single-planar here: the UV rows follow the Y rows with the same stride
+    cv::Mat view;
+    if (m_pixelFormat == V4L2_PIX_FMT_BGR24)
+        view = cv::Mat(m_height, m_width, CV_8UC3, b.start, (size_t)m_bytesPerLine);
+    else if (m_pixelFormat == V4L2_PIX_FMT_YUYV)
+        view = cv::Mat(m_height, m_width, CV_8UC2, b.start, (size_t)m_bytesPerLine);
+    else
+        view = cv::Mat(m_height * 3 / 2, m_width, CV_8UC1, b.start, (size_t)m_bytesPerLine);
+
+    if (m_zeroCopy) {
+        // hand the driver buffer itself to the pipeline; it is queued again in releaseFrame()
+        frame = view;
+        return true;
+    }
+
+    // the slot may still point at a driver buffer from an earlier zero-copy frame
+    if (!frame.empty() && !frame.u) frame.release();
+    cv::cvtColor(view, frame, m_pixelFormat == V4L2_PIX_FMT_YUYV ? cv::COLOR_YUV2BGR_YUYV : cv::COLOR_YUV2BGR_NV12);
+    queueBuffer((int)buf.index);
+    return true;
+}
+
+void V4L2Source::releaseFrame(const cv::Mat& frame) {
+    if (!m_zeroCopy || frame.empty()) return;
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        if (m_buffers[i].start == frame.data) {
+            if (!m_buffers[i].queued) queueBuffer((int)i);
+            return;
+        }
+    }
+}
+
+bool V4L2Source::setResolution(int width, int height) {
+    if (m_fd < 0) return false;
+    stopStreaming();
+    m_width = width;
+    m_height = height;
+    if (!startStreaming()) return false;
+    return m_width == width && m_height == height;
+}
+
+#else
+
+bool V4L2Source::open() {
+    std::cerr << "[V4L2] The V4L2 backend is only available on Linux\n";
+    return false;
+}
+
+void V4L2Source::close() {}
+bool V4L2Source::read(cv::Mat&) { return false; }
+void V4L2Source::releaseFrame(const cv::Mat&) {}
+bool V4L2Source::setResolution(int, int) { return false; }
+bool V4L2Source::startStreaming() { return false; }
+void V4L2Source::stopStreaming() {}
+bool V4L2Source::queueBuffer(int) { return false; }
+
+#endif
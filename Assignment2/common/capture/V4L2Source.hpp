@@ -0,0 +1,77 @@
+/*
+ * V4L2Source.hpp
+ *
+ *  Linux capture backend that talks to V4L2 directly, using MMAP streaming I/O
+ *  instead of cv::VideoCapture.
+ *
+ */
+#ifndef V4L2SOURCE_HPP
+#define V4L2SOURCE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "FrameSource.hpp"
+
+//!  V4L2Source.
+/*!
+ Requests driver buffers with VIDIOC_REQBUFS, maps them and streams with QBUF/DQBUF.
+ When the device can deliver BGR24 the frames handed to the pipeline are views of the mapped
+ driver buffers (no copy, no colour conversion); a buffer is only queued back to the driver once
+ the pipeline calls releaseFrame() for it. Otherwise YUYV or NV12 is captured and converted once.
+ If a YUV output format is requested, that layout is negotiated first and handed out as
+ zero-copy views as well, so the GPU path can upload the planes and convert in the shader.
+ Only available on Linux; open() fails elsewhere. Can be exercised with the vivid test driver.
+ */
+class V4L2Source : public FrameSource {
+public:
+    V4L2Source(const std::string& device, int width, int height, double fps,
+               FramePixelFormat output = FRAME_BGR24);
+    ~V4L2Source();
+
+    bool open();
+    void close();
+    bool read(cv::Mat& frame);
+    bool setResolution(int width, int height);
+    cv::Size resolution();
+    std::string name() const;
+    std::string backendName() const;
+
+    bool holdsBuffers() const { return m_zeroCopy; }
+    FramePixelFormat pixelFormat() const { return m_outputFormat; }
+    void releaseFrame(const cv::Mat& frame);
+
+private:
+    struct Buffer {
+        unsigned char* start = nullptr;
+        size_t length = 0;
+        bool queued = false;
+    };
+
+    //! startStreaming
+    /*! Negotiates format and frame rate, maps the buffers and starts the stream. */
+    bool startStreaming();
+    //! stopStreaming
+    /*! Stops the stream and unmaps all buffers. No frame views may be outstanding. */
+    void stopStreaming();
+    bool queueBuffer(int index);
+
+    std::string m_device;
+    int m_fd;
+    int m_width;
+    int m_height;
+    int m_bytesPerLine;
+    double m_fps;
+    FramePixelFormat m_requestedFormat;
+    FramePixelFormat m_outputFormat;    //!< what read() hands out
+    uint32_t m_pixelFormat;             //!< what the driver delivers
+    bool m_zeroCopy;
+    bool m_streaming;
+    std::string m_backend;              //!< backendName(), set when the format is negotiated
+
+    std::vector<Buffer> m_buffers;
+    std::mutex m_bufferMutex;       //!< releaseFrame() runs on the consumer and capture threads
+};
+
+#endif
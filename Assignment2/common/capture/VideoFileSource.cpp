@@ -0,0 +1,65 @@
+#include "VideoFileSource.hpp"
+
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+VideoFileSource::VideoFileSource(const std::string& path, double fps)
+    : m_path(path), m_fps(fps) {}
+
+VideoFileSource::~VideoFileSource() {
+    close();
+}
+
+bool VideoFileSource::open() {
+    if (!m_cap.open(m_path)) {
+        std::cerr << "Error: could not open video file " << m_path << "\n";
+        return false;
+    }
+    m_fileSize = cv::Size((int)m_cap.get(cv::CAP_PROP_FRAME_WIDTH), (int)m_cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+    m_outSize = m_fileSize;
+    m_nextFrame = std::chrono::steady_clock::now();
+    return true;
+}
+
+void VideoFileSource::close() {
+    if (m_cap.isOpened()) m_cap.release();
+}
+
+bool VideoFileSource::read(cv::Mat& frame) {
+    if (m_fps > 0.0) {
+        std::this_thread::sleep_until(m_nextFrame);
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / m_fps));
+        m_nextFrame = std::max(m_nextFrame + period, std::chrono::steady_clock::now());
+    }
+
+    bool resize = m_outSize != m_fileSize;
+    cv::Mat& target = resize ? m_decoded : frame;
+    if (!m_cap.read(target) || target.empty()) {
+        // end of file: rewind and try once more
+        m_cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+        if (!m_cap.read(target) || target.empty()) return false;
+    }
+    if (resize) {
+        cv::resize(m_decoded, frame, m_outSize, 0, 0, cv::INTER_AREA);
+    }
+    return true;
+}
+
+bool VideoFileSource::setResolution(int width, int height) {
+    m_outSize = cv::Size(width, height);
+    return true;
+}
+
+cv::Size VideoFileSource::resolution() {
+    return m_outSize;
+}
+
+std::string VideoFileSource::name() const {
+    return "file:" + m_path;
+}
+
+std::string VideoFileSource::backendName() const {
+    return m_cap.isOpened() ? "opencv-" + m_cap.getBackendName() : "opencv";
+}
@@ -0,0 +1,44 @@
+/*
+ * VideoFileSource.hpp
+ *
+ *  FrameSource that plays a video file in a loop.
+ *
+ */
+#ifndef VIDEOFILESOURCE_HPP
+#define VIDEOFILESOURCE_HPP
+
+#include <chrono>
+
+#include "FrameSource.hpp"
+
+//!  VideoFileSource.
+/*!
+ Decodes a video file with cv::VideoCapture and rewinds at the end. Frames are resized when a
+ resolution other than the file's own is requested, so the batch resolution sweep still works.
+ */
+class VideoFileSource : public FrameSource {
+public:
+    //! Constructor
+    /*! fps paces the reads like a camera would; 0 reads as fast as the decoder allows. */
+    VideoFileSource(const std::string& path, double fps);
+    ~VideoFileSource();
+
+    bool open();
+    void close();
+    bool read(cv::Mat& frame);
+    bool setResolution(int width, int height);
+    cv::Size resolution();
+    std::string name() const;
+    std::string backendName() const;
+
+private:
+    cv::VideoCapture m_cap;
+    std::string m_path;
+    double m_fps;
+    cv::Size m_fileSize;
+    cv::Size m_outSize;
+    cv::Mat m_decoded;      //!< decode target when frames have to be resized
+    std::chrono::steady_clock::time_point m_nextFrame;
+};
+
+#endif
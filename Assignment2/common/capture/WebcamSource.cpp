@@ -0,0 +1,108 @@
+#include "WebcamSource.hpp"
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+WebcamSource::WebcamSource(int deviceIndex, int width, int height, double fps, bool mjpg)
+    : m_deviceIndex(deviceIndex), m_width(width), m_height(height), m_fps(fps),
+      m_mjpg(mjpg), m_compressed(false) {}
+
+static bool looksCompressed(const cv::Mat& frame) {
+    return frame.type() == CV_8UC1 && frame.rows == 1 && frame.cols > 2 &&
+           frame.ptr<uchar>(0)[0] == 0xFF && frame.ptr<uchar>(0)[1] == 0xD8;   // JPEG SOI marker
+}
+
+WebcamSource::~WebcamSource() {
+    close();
+}
+
+bool WebcamSource::open() {
+    if (!m_cap.open(m_deviceIndex)) {
+        std::cerr << "Error: could not open camera " << m_deviceIndex << "\n";
+        return false;
+    }
+
+    // the fourcc has to go in before the size, most drivers only offer large sizes as MJPG
+    if (m_mjpg) m_cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    m_cap.set(cv::CAP_PROP_FRAME_WIDTH, m_width);
+    m_cap.set(cv::CAP_PROP_FRAME_HEIGHT, m_height);
+    m_cap.set(cv::CAP_PROP_FPS, m_fps);
+    m_width = (int)m_cap.get(cv::CAP_PROP_FRAME_WIDTH);
+    m_height = (int)m_cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+
+    if (!warmup(80, 15)) {
+        std::cerr << "[WARN] Camera warmup failed to get frames quickly — continuing anyway\n";
+    }
+    if (m_mjpg && !negotiateMjpg()) {
+        std::cerr << "[WARN] Camera did not deliver MJPG — falling back to converted frames\n";
+    }
+    return true;
+}
+
+void WebcamSource::close() {
+    if (m_cap.isOpened()) m_cap.release();
+}
+
+bool WebcamSource::warmup(int maxAttempts, int msBetween) {
+    cv::Mat tmp;
+    for (int i = 0; i < maxAttempts; ++i) {
+        m_cap >> tmp;
+        if (!tmp.empty()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(msBetween));
+    }
+    return false;
+}
+
+bool WebcamSource::negotiateMjpg() {
+    int fourcc = (int)m_cap.get(cv::CAP_PROP_FOURCC);
+    if (fourcc != cv::VideoWriter::fourcc('M', 'J', 'P', 'G')) return false;
+
+    m_cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    cv::Mat probe;
+    for (int i = 0; i < 10 && probe.empty(); ++i) m_cap.read(probe);
+    if (looksCompressed(probe)) {
+        m_compressed = true;
+        return true;
+    }
+    // the backend ignored CONVERT_RGB, keep its decoded output
+    m_cap.set(cv::CAP_PROP_CONVERT_RGB, 1);
+    m_compressed = false;
+    return false;
+}
+
+// Rejects frames with an inconsistent step, or anything but JPEG bytes in MJPG mode
+bool WebcamSource::read(cv::Mat& frame) {
+    if (!m_cap.read(frame) || frame.empty()) {
+        return false;
+    }
+    if (m_compressed) {
+        return looksCompressed(frame);
+    }
+    if (frame.step < (size_t)frame.cols * (size_t)frame.elemSize1() * (size_t)frame.channels()) {
+        return false;
+    }
+    return true;
+}
+
+bool WebcamSource::setResolution(int width, int height) {
+    if (m_mjpg) m_cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    m_cap.set(cv::CAP_PROP_FRAME_WIDTH, width);
+    m_cap.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    m_width = (int)m_cap.get(cv::CAP_PROP_FRAME_WIDTH);
+    m_height = (int)m_cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+    return m_width == width && m_height == height;
+}
+
+cv::Size WebcamSource::resolution() {
+    return cv::Size(m_width, m_height);
+}
+
+std::string WebcamSource::name() const {
+    return "webcam:" + std::to_string(m_deviceIndex);
+}
+
+std::string WebcamSource::backendName() const {
+    if (!m_cap.isOpened()) return "opencv";
+    return "opencv-" + m_cap.getBackendName() + (m_compressed ? "-mjpg" : "");
+}
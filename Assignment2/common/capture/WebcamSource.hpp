@@ -0,0 +1,50 @@
+/*
+ * WebcamSource.hpp
+ *
+ *  FrameSource backed by cv::VideoCapture on a camera index.
+ *
+ */
+#ifndef WEBCAMSOURCE_HPP
+#define WEBCAMSOURCE_HPP
+
+#include "FrameSource.hpp"
+
+//!  WebcamSource.
+/*!
+ Opens the camera, requests size and frame rate and warms it up until it delivers frames.
+ With mjpg set it negotiates MJPG and turns off OpenCV's conversion, so read() returns the
+ compressed bytes; if the camera or backend refuses, it falls back to converted BGR frames.
+ */
+class WebcamSource : public FrameSource {
+public:
+    WebcamSource(int deviceIndex, int width, int height, double fps, bool mjpg = false);
+    ~WebcamSource();
+
+    bool open();
+    void close();
+    bool read(cv::Mat& frame);
+    bool setResolution(int width, int height);
+    cv::Size resolution();
+    std::string name() const;
+    std::string backendName() const;
+    bool isCompressed() const { return m_compressed; }
+
+private:
+    //! negotiateMjpg
+    /*! Requests MJPG without conversion and checks that compressed frames actually arrive. */
+    bool negotiateMjpg();
+
+    //! warmup
+    /*! Some drivers return empty frames for a while after opening. */
+    bool warmup(int maxAttempts = 80, int msBetween = 15);
+
+    cv::VideoCapture m_cap;
+    int m_deviceIndex;
+    int m_width;
+    int m_height;
+    double m_fps;
+    bool m_mjpg;
+    bool m_compressed;
+};
+
+#endif
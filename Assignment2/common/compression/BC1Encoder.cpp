@@ -0,0 +1,219 @@
+#include "BC1Encoder.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC1_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace BC1 {
+
+namespace {
+
+inline uint16_t toRGB565(int r, int g, int b) {
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// 565 back to 8 bits per channel, replicating the high bits as the GPU does
+inline void fromRGB565(uint16_t c, int& r, int& g, int& b) {
+    r = (c >> 11) & 31; r = (r << 3) | (r >> 2);
+    g = (c >> 5) & 63;  g = (g << 2) | (g >> 4);
+    b = c & 31;         b = (b << 3) | (b >> 2);
+}
+
+// Gathers a 4x4 block as 16 BGRX pixels, clamping at the right and bottom edges
+inline void loadBlock(const cv::Mat& bgr, int bx, int by, uint8_t* bgrx) {
+    for (int y = 0; y < 4; ++y) {
+        const uint8_t* row = bgr.ptr<uint8_t>(std::min(by * 4 + y, bgr.rows - 1));
+        for (int x = 0; x < 4; ++x) {
+            const uint8_t* p = row + 3 * std::min(bx * 4 + x, bgr.cols - 1);
+            uint8_t* d = bgrx + 4 * (4 * y + x);
+            d[0] = p[0]; d[1] = p[1]; d[2] = p[2]; d[3] = 0;
+        }
+    }
+}
+
+// Endpoints from the bounding box, shrunk by 1/16 of its size on each side so outliers do not
+// stretch the palette. Returns false if the block is a single colour.
+inline bool chooseEndpoints(const int mn[3], const int mx[3], uint16_t& c0, uint16_t& c1) {
+    int lo[3], hi[3];
+    for (int c = 0; c < 3; ++c) {
+        int inset = (mx[c] - mn[c]) >> 4;
+        lo[c] = mn[c] + inset;
+        hi[c] = mx[c] - inset;
+    }
+    // channel order in the arrays is B, G, R
+    c0 = toRGB565(hi[2], hi[1], hi[0]);
+    c1 = toRGB565(lo[2], lo[1], lo[0]);
+    return c0 != c1;   // hi >= lo per channel, so c0 >= c1 and the block is in 4-colour mode
+}
+
+inline void writeBlock(uint8_t* out, uint16_t c0, uint16_t c1, uint32_t indices) {
+    out[0] = (uint8_t)c0; out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)c1; out[3] = (uint8_t)(c1 >> 8);
+    out[4] = (uint8_t)indices; out[5] = (uint8_t)(indices >> 8);
+    out[6] = (uint8_t)(indices >> 16); out[7] = (uint8_t)(indices >> 24);
+}
+
+// position along the endpoint line (0 = c0 ... 3 = c1) to BC1 index
+const uint32_t kLineToIndex[4] = { 0, 2, 3, 1 };
+
+void encodeBlockScalar(const uint8_t* bgrx, uint8_t* out) {
+    int mn[3] = { 255, 255, 255 }, mx[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c) {
+            mn[c] = std::min(mn[c], (int)bgrx[4 * i + c]);
+            mx[c] = std::max(mx[c], (int)bgrx[4 * i + c]);
+        }
+    uint16_t c0, c1;
+    if (!chooseEndpoints(mn, mx, c0, c1)) {
+        writeBlock(out, c0, c1, 0);
+        return;
+    }
+
+    int r0, g0, b0, r1, g1, b1;
+    fromRGB565(c0, r0, g0, b0);
+    fromRGB565(c1, r1, g1, b1);
+    const int db = b1 - b0, dg = g1 - g0, dr = r1 - r0;
+    const int len2 = db * db + dg * dg + dr * dr;
+    const int base = b0 * db + g0 * dg + r0 * dr;
+
+    uint32_t indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        const uint8_t* p = bgrx + 4 * i;
+        // 6 * projection against the midpoints 1/6, 3/6 and 5/6 of the line
+        int d6 = 6 * (p[0] * db + p[1] * dg + p[2] * dr - base);
+        int t = (d6 >= len2) + (d6 >= 3 * len2) + (d6 >= 5 * len2);
+        indices |= kLineToIndex[t] << (2 * i);
+    }
+    writeBlock(out, c0, c1, indices);
+}
+
+#ifdef BC1_SSE2
+void encodeBlockSSE2(const uint8_t* bgrx, uint8_t* out) {
+    const __m128i p0 = _mm_loadu_si128((const __m128i*)(bgrx + 0));
+    const __m128i p1 = _mm_loadu_si128((const __m128i*)(bgrx + 16));
+    const __m128i p2 = _mm_loadu_si128((const __m128i*)(bgrx + 32));
+    const __m128i p3 = _mm_loadu_si128((const __m128i*)(bgrx + 48));
+
+    // per-channel min/max over the 16 pixels, then fold the four pixels of a register together
+    __m128i mn = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+    __m128i mx = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+    const uint32_t mnBits = (uint32_t)_mm_cvtsi128_si32(mn), mxBits = (uint32_t)_mm_cvtsi128_si32(mx);
+    const int mnc[3] = { (int)(mnBits & 255), (int)((mnBits >> 8) & 255), (int)((mnBits >> 16) & 255) };
+    const int mxc[3] = { (int)(mxBits & 255), (int)((mxBits >> 8) & 255), (int)((mxBits >> 16) & 255) };
+
+    uint16_t c0, c1;
+    if (!chooseEndpoints(mnc, mxc, c0, c1)) {
+        writeBlock(out, c0, c1, 0);
+        return;
+    }
+    int r0, g0, b0, r1, g1, b1;
+    fromRGB565(c0, r0, g0, b0);
+    fromRGB565(c1, r1, g1, b1);
+    const int db = b1 - b0, dg = g1 - g0, dr = r1 - r0;
+    const int len2 = db * db + dg * dg + dr * dr;
+    const int base = b0 * db + g0 * dg + r0 * dr;
+
+    // dot products with madd on 16-bit lanes: (b*db + g*dg), (r*dr + x*0) per pixel
+    const __m128i dir = _mm_setr_epi16((short)db, (short)dg, (short)dr, 0, (short)db, (short)dg, (short)dr, 0);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vBase = _mm_set1_epi32(base);
+    const __m128i t1 = _mm_set1_epi32(len2 - 1), t3 = _mm_set1_epi32(3 * len2 - 1), t5 = _mm_set1_epi32(5 * len2 - 1);
+    const __m128i pix[4] = { p0, p1, p2, p3 };
+    uint32_t indices = 0;
+    for (int r = 0; r < 4; ++r) {
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pix[r], zero), dir);     // pixels 0, 1
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pix[r], zero), dir);     // pixels 2, 3
+        // add the two halves of each pixel: lanes (0+1) and (2+3)
+        __m128i sumLo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+        __m128i sumHi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+        // gather lanes 0 and 2 of both into one register of four dots
+        __m128i dots = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(sumLo), _mm_castsi128_ps(sumHi),
+                                                       _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i d = _mm_sub_epi32(dots, vBase);
+        __m128i d6 = _mm_add_epi32(_mm_slli_epi32(d, 2), _mm_slli_epi32(d, 1));
+        // each comparison yields -1 where passed, so the negated sum is the line position 0..3
+        __m128i t = _mm_add_epi32(_mm_add_epi32(_mm_cmpgt_epi32(d6, t1), _mm_cmpgt_epi32(d6, t3)),
+                                  _mm_cmpgt_epi32(d6, t5));
+        t = _mm_sub_epi32(zero, t);
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128((__m128i*)lanes, t);
+        for (int i = 0; i < 4; ++i) indices |= kLineToIndex[lanes[i]] << (2 * (4 * r + i));
+    }
+    writeBlock(out, c0, c1, indices);
+}
+#endif
+
+} // namespace
+
+size_t compressedSize(int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+bool simdAvailable() {
+#ifdef BC1_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void encode(const cv::Mat& bgr, std::vector<uint8_t>& blocks, int threads, bool simd) {
+    CV_Assert(bgr.type() == CV_8UC3);
+    const int blocksX = (bgr.cols + 3) / 4, blocksY = (bgr.rows + 3) / 4;
+    blocks.resize(compressedSize(bgr.cols, bgr.rows));
+    uint8_t* out = blocks.data();
+
+    void (*encodeBlock)(const uint8_t*, uint8_t*) = encodeBlockScalar;
+#ifdef BC1_SSE2
+    if (simd) encodeBlock = encodeBlockSSE2;
+#endif
+
+    cv::parallel_for_(cv::Range(0, blocksY), [&](const cv::Range& rows) {
+        alignas(16) uint8_t bgrx[64];
+        for (int by = rows.start; by < rows.end; ++by)
+            for (int bx = 0; bx < blocksX; ++bx) {
+                loadBlock(bgr, bx, by, bgrx);
+                encodeBlock(bgrx, out + 8 * ((size_t)by * blocksX + bx));
+            }
+    }, threads > 0 ? threads : -1);
+}
+
+void decode(const uint8_t* blocks, int width, int height, cv::Mat& bgr) {
+    bgr.create(height, width, CV_8UC3);
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    for (int by = 0; by < blocksY; ++by)
+        for (int bx = 0; bx < blocksX; ++bx) {
+            const uint8_t* b = blocks + 8 * ((size_t)by * blocksX + bx);
+            uint16_t c0 = (uint16_t)(b[0] | (b[1] << 8)), c1 = (uint16_t)(b[2] | (b[3] << 8));
+            uint32_t indices = (uint32_t)b[4] | ((uint32_t)b[5] << 8) | ((uint32_t)b[6] << 16) | ((uint32_t)b[7] << 24);
+            int pal[4][3];
+            fromRGB565(c0, pal[0][2], pal[0][1], pal[0][0]);
+            fromRGB565(c1, pal[1][2], pal[1][1], pal[1][0]);
+            for (int c = 0; c < 3; ++c) {
+                if (c0 > c1) {
+                    pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+                    pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+                } else {
+                    pal[2][c] = (pal[0][c] + pal[1][c]) / 2;
+                    pal[3][c] = 0;
+                }
+            }
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y) {
+                uint8_t* row = bgr.ptr<uint8_t>(by * 4 + y);
+                for (int x = 0; x < 4 && bx * 4 + x < width; ++x) {
+                    const int* c = pal[(indices >> (2 * (4 * y + x))) & 3];
+                    uint8_t* p = row + 3 * (bx * 4 + x);
+                    p[0] = (uint8_t)c[0]; p[1] = (uint8_t)c[1]; p[2] = (uint8_t)c[2];
+                }
+            }
+        }
+}
+
+}
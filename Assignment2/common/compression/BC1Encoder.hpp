@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Real-time BC1 (DXT1) compression of video frames, 4 bits per pixel (6:1 against BGR24).
+// Each 4x4 block takes the inset bounding box of its colours as endpoints and picks every pixel's
+// index by projecting it onto the endpoint line, the usual trade of quality for speed in
+// real-time encoders. Blocks are written top-down, row by row, as glCompressedTexSubImage2D
+// expects them for GL_COMPRESSED_RGB_S3TC_DXT1_EXT.
+namespace BC1 {
+
+    // Bytes of BC1 data for a width x height image (edges padded to whole blocks)
+    size_t compressedSize(int width, int height);
+
+    // Encodes a CV_8UC3 BGR image. threads = number of stripes the block rows are split into for
+    // cv::parallel_for_ (0 = OpenCV's default); simd = false forces the scalar block encoder.
+    void encode(const cv::Mat& bgr, std::vector<uint8_t>& blocks, int threads = 0, bool simd = true);
+
+    // Decodes BC1 blocks back to BGR, for measuring quality
+    void decode(const uint8_t* blocks, int width, int height, cv::Mat& bgr);
+
+    // True if encode() has a SIMD block encoder on this build
+    bool simdAvailable();
+
+}
@@ -1,9 +1,603 @@
 #include "CPUFilters.hpp"
+#include "../WorkStealingPool.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPUFILTERS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// SSSE3 and AVX2 kernels are compiled for their ISA and picked at runtime
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPUFILTERS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CPUFILTERS_TARGET(isa)
+#else
+#define CPUFILTERS_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
 
 namespace CPUFilters {
 
+namespace {
+
+// Runs body(rows) for bands of bandRows rows on the shared pool, with at most threads participants
+// (0 = the pool's active count)
+template <typename Body>
+void forRowBands(int rows, int bandRows, int threads, const Body& body) {
+    bandRows = std::max(1, bandRows);
+    WorkStealingPool::shared().run((rows + bandRows - 1) / bandRows, [&](int i) {
+        body(cv::Range(i * bandRows, std::min(rows, (i + 1) * bandRows)));
+    }, threads);
+}
+
+// Runs body(tile) for the pool's cache-sized tiles of an image of the given size, row by row of
+// tiles so that the chunk each worker starts with is a horizontal band
+template <typename Body>
+void forTiles(cv::Size size, int threads, const Body& body) {
+    WorkStealingPool& pool = WorkStealingPool::shared();
+    const int tw = pool.tileWidth(), th = pool.tileHeight();
+    const int tilesX = (size.width + tw - 1) / tw, tilesY = (size.height + th - 1) / th;
+    pool.run(tilesX * tilesY, [&](int i) {
+        const int x = (i % tilesX) * tw, y = (i / tilesX) * th;
+        body(cv::Rect(x, y, std::min(tw, size.width - x), std::min(th, size.height - y)));
+    }, threads);
+}
+
+// cv::COLOR_BGR2GRAY's fixed-point weights (Q14, rounded), so the fused kernel matches cvtColor
+const int kGrayB = 1868;
+const int kGrayG = 9617;
+const int kGrayR = 4899;
+const int kGrayShift = 14;
+
+// r > 150 && r > 1.3 g && r > 1.3 b, in integers: 10 r > 13 g is exactly r > g * 1.3 for 8-bit values
+inline bool keepsRed(int b, int g, int r) {
+    return r > 150 && 10 * r > 13 * g && 10 * r > 13 * b;
+}
+
+void sinCityPixels(const uint8_t* s, uint8_t* d, int n) {
+    for (int x = 0; x < n; ++x, s += 3, d += 3) {
+        int b = s[0], g = s[1], r = s[2];
+        if (keepsRed(b, g, r)) {
+            d[0] = (uint8_t)b; d[1] = (uint8_t)g; d[2] = (uint8_t)r;
+        } else {
+            uint8_t y = (uint8_t)((b * kGrayB + g * kGrayG + r * kGrayR + (1 << (kGrayShift - 1))) >> kGrayShift);
+            d[0] = d[1] = d[2] = y;
+        }
+    }
+}
+
+#ifdef CPUFILTERS_X86
+// pshufb controls: gather B, G or R of 16 pixels from each of the three 16-byte chunks they span
+const int8_t kGather[3][3][16] = {
+    { { 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13 } },
+    { { 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14 } },
+    { { 2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15 } },
+};
+// pshufb controls: spread 16 per-pixel bytes over the three output chunks, three copies each
+const int8_t kSpread[3][16] = {
+    { 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5 },
+    { 5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10 },
+    { 10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15 },
+};
+
+// 16 pixels per iteration; returns how many pixels were done, the caller finishes the row
+CPUFILTERS_TARGET("ssse3")
+int sinCityPixelsSSSE3(const uint8_t* s, uint8_t* d, int n) {
+    __m128i gather[3][3], spread[3];
+    for (int c = 0; c < 3; ++c) {
+        for (int k = 0; k < 3; ++k) gather[c][k] = _mm_loadu_si128((const __m128i*)kGather[c][k]);
+        spread[c] = _mm_loadu_si128((const __m128i*)kSpread[c]);
+    }
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightsBG = _mm_set1_epi32((kGrayG << 16) | kGrayB);
+    const __m128i weightsR1 = _mm_set1_epi32(((1 << (kGrayShift - 1)) << 16) | kGrayR);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i redMin = _mm_set1_epi16(150);
+    const __m128i ten = _mm_set1_epi16(10);
+    const __m128i thirteen = _mm_set1_epi16(13);
+
+    int x = 0;
+    for (; x + 16 <= n; x += 16, s += 48, d += 48) {
+        __m128i in[3], ch[3];
+        for (int k = 0; k < 3; ++k) in[k] = _mm_loadu_si128((const __m128i*)(s + 16 * k));
+        for (int c = 0; c < 3; ++c)
+            ch[c] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in[0], gather[c][0]), _mm_shuffle_epi8(in[1], gather[c][1])),
+                                 _mm_shuffle_epi8(in[2], gather[c][2]));
+
+        __m128i gray16[2], keep16[2];
+        for (int h = 0; h < 2; ++h) {
+            __m128i b = h ? _mm_unpackhi_epi8(ch[0], zero) : _mm_unpacklo_epi8(ch[0], zero);
+            __m128i g = h ? _mm_unpackhi_epi8(ch[1], zero) : _mm_unpacklo_epi8(ch[1], zero);
+            __m128i r = h ? _mm_unpackhi_epi8(ch[2], zero) : _mm_unpacklo_epi8(ch[2], zero);
+            // (b, g) and (r, 1) pairs against (wB, wG) and (wR, rounding): exact 32-bit sums
+            __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b, g), weightsBG),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(r, one), weightsR1));
+            __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b, g), weightsBG),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(r, one), weightsR1));
+            gray16[h] = _mm_packs_epi32(_mm_srli_epi32(lo, kGrayShift), _mm_srli_epi32(hi, kGrayShift));
+            __m128i r10 = _mm_mullo_epi16(r, ten);
+            keep16[h] = _mm_and_si128(_mm_cmpgt_epi16(r, redMin),
+                                      _mm_and_si128(_mm_cmpgt_epi16(r10, _mm_mullo_epi16(g, thirteen)),
+                                                    _mm_cmpgt_epi16(r10, _mm_mullo_epi16(b, thirteen))));
+        }
+        __m128i gray = _mm_packus_epi16(gray16[0], gray16[1]);
+        __m128i keep = _mm_packs_epi16(keep16[0], keep16[1]);
+        for (int k = 0; k < 3; ++k) {
+            __m128i m = _mm_shuffle_epi8(keep, spread[k]);
+            __m128i out = _mm_or_si128(_mm_and_si128(m, in[k]), _mm_andnot_si128(m, _mm_shuffle_epi8(gray, spread[k])));
+            _mm_storeu_si128((__m128i*)(d + 16 * k), out);
+        }
+    }
+    return x;
+}
+
+// Same as the SSSE3 kernel on 32 pixels: each 128-bit lane holds 16 of them, since the shuffles,
+// unpacks and packs all stay within a lane
+CPUFILTERS_TARGET("avx2")
+int sinCityPixelsAVX2(const uint8_t* s, uint8_t* d, int n) {
+    __m256i gather[3][3], spread[3];
+    for (int c = 0; c < 3; ++c) {
+        for (int k = 0; k < 3; ++k) gather[c][k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)kGather[c][k]));
+        spread[c] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)kSpread[c]));
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i weightsBG = _mm256_set1_epi32((kGrayG << 16) | kGrayB);
+    const __m256i weightsR1 = _mm256_set1_epi32(((1 << (kGrayShift - 1)) << 16) | kGrayR);
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i redMin = _mm256_set1_epi16(150);
+    const __m256i ten = _mm256_set1_epi16(10);
+    const __m256i thirteen = _mm256_set1_epi16(13);
+
+    int x = 0;
+    for (; x + 32 <= n; x += 32, s += 96, d += 96) {
+        __m256i in[3], ch[3];
+        for (int k = 0; k < 3; ++k)
+            in[k] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(s + 16 * k))),
+                                            _mm_loadu_si128((const __m128i*)(s + 48 + 16 * k)), 1);
+        for (int c = 0; c < 3; ++c)
+            ch[c] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(in[0], gather[c][0]),
+                                                    _mm256_shuffle_epi8(in[1], gather[c][1])),
+                                    _mm256_shuffle_epi8(in[2], gather[c][2]));
+
+        __m256i gray16[2], keep16[2];
+        for (int h = 0; h < 2; ++h) {
+            __m256i b = h ? _mm256_unpackhi_epi8(ch[0], zero) : _mm256_unpacklo_epi8(ch[0], zero);
+            __m256i g = h ? _mm256_unpackhi_epi8(ch[1], zero) : _mm256_unpacklo_epi8(ch[1], zero);
+            __m256i r = h ? _mm256_unpackhi_epi8(ch[2], zero) : _mm256_unpacklo_epi8(ch[2], zero);
+            __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(b, g), weightsBG),
+                                          _mm256_madd_epi16(_mm256_unpacklo_epi16(r, one), weightsR1));
+            __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(b, g), weightsBG),
+                                          _mm256_madd_epi16(_mm256_unpackhi_epi16(r, one), weightsR1));
+            gray16[h] = _mm256_packs_epi32(_mm256_srli_epi32(lo, kGrayShift), _mm256_srli_epi32(hi, kGrayShift));
+            __m256i r10 = _mm256_mullo_epi16(r, ten);
+            keep16[h] = _mm256_and_si256(_mm256_cmpgt_epi16(r, redMin),
+                                         _mm256_and_si256(_mm256_cmpgt_epi16(r10, _mm256_mullo_epi16(g, thirteen)),
+                                                          _mm256_cmpgt_epi16(r10, _mm256_mullo_epi16(b, thirteen))));
+        }
+        __m256i gray = _mm256_packus_epi16(gray16[0], gray16[1]);
+        __m256i keep = _mm256_packs_epi16(keep16[0], keep16[1]);
+        for (int k = 0; k < 3; ++k) {
+            __m256i m = _mm256_shuffle_epi8(keep, spread[k]);
+            __m256i out = _mm256_or_si256(_mm256_and_si256(m, in[k]),
+                                          _mm256_andnot_si256(m, _mm256_shuffle_epi8(gray, spread[k])));
+            _mm_storeu_si128((__m128i*)(d + 16 * k), _mm256_castsi256_si128(out));
+            _mm_storeu_si128((__m128i*)(d + 48 + 16 * k), _mm256_extracti128_si256(out, 1));
+        }
+    }
+    return x;
+}
+#endif
+
+// Adds n bytes of a row to per-byte column sums; the SIMD versions return how many they did
+void accumulateRow(const uint8_t* row, uint32_t* sums, int n) {
+    for (int i = 0; i < n; ++i) sums[i] += row[i];
+}
+
+#ifdef CPUFILTERS_X86
+CPUFILTERS_TARGET("sse2")
+int accumulateRowSSE2(const uint8_t* row, uint32_t* sums, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i w[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                         _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+        for (int k = 0; k < 4; ++k) {
+            __m128i* s = (__m128i*)(sums + i + 4 * k);
+            _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s), w[k]));
+        }
+    }
+    return i;
+}
+
+CPUFILTERS_TARGET("avx2")
+int accumulateRowAVX2(const uint8_t* row, uint32_t* sums, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(row + i));
+        __m256i lo = _mm256_cvtepu8_epi32(v);
+        __m256i hi = _mm256_cvtepu8_epi32(_mm_unpackhi_epi64(v, v));
+        __m256i* s0 = (__m256i*)(sums + i);
+        __m256i* s1 = (__m256i*)(sums + i + 8);
+        _mm256_storeu_si256(s0, _mm256_add_epi32(_mm256_loadu_si256(s0), lo));
+        _mm256_storeu_si256(s1, _mm256_add_epi32(_mm256_loadu_si256(s1), hi));
+    }
+    return i;
+}
+#endif
+
+// Mean colour of every pixelSize block as pixelateReference computes it (cv::mean's
+// sum * (1 / count), rounded by the Scalar-to-pixel conversion of cv::rectangle), as a
+// blocksY x blocksX CV_8UC3 image. Column sums of each block row are accumulated with SIMD.
+void blockMeans(const cv::Mat& src, int pixelSize, SimdLevel simd, int threads, cv::Mat& means) {
+    const int rowBytes = src.cols * 3;
+    const int blocksX = (src.cols + pixelSize - 1) / pixelSize;
+    const int blocksY = (src.rows + pixelSize - 1) / pixelSize;
+    means.create(blocksY, blocksX, CV_8UC3);
+    // whole block rows, about a tile high
+    forRowBands(blocksY, WorkStealingPool::shared().tileHeight() / pixelSize, threads, [&](const cv::Range& range) {
+        std::vector<uint32_t> sums(rowBytes);
+        for (int by = range.start; by < range.end; ++by) {
+            const int y0 = by * pixelSize;
+            const int y1 = std::min(y0 + pixelSize, src.rows);
+            std::fill(sums.begin(), sums.end(), 0u);
+            for (int y = y0; y < y1; ++y) {
+                const uint8_t* row = src.ptr<uint8_t>(y);
+                int i = 0;
+#ifdef CPUFILTERS_X86
+                if (simd == SIMD_AVX2) i = accumulateRowAVX2(row, sums.data(), rowBytes);
+                else if (simd == SIMD_SSSE3) i = accumulateRowSSE2(row, sums.data(), rowBytes);
+#endif
+                accumulateRow(row + i, sums.data() + i, rowBytes - i);
+            }
+            uint8_t* out = means.ptr<uint8_t>(by);
+            for (int bx = 0; bx < blocksX; ++bx) {
+                const int x0 = bx * pixelSize;
+                const int x1 = std::min(x0 + pixelSize, src.cols);
+                const double scale = 1.0 / ((double)(x1 - x0) * (y1 - y0));
+                uint64_t blockSum[3] = { 0, 0, 0 };
+                for (int x = x0; x < x1; ++x)
+                    for (int c = 0; c < 3; ++c) blockSum[c] += sums[3 * x + c];
+                for (int c = 0; c < 3; ++c) out[3 * bx + c] = cv::saturate_cast<uint8_t>((double)blockSum[c] * scale);
+            }
+        }
+    });
+}
+
+// Filtered source pixels for filterWarp, fetched at the four bilinear taps
+struct PlainTap {
+    const cv::Mat& src;
+    inline void operator()(int x, int y, int v[3]) const {
+        const uint8_t* p = src.ptr<uint8_t>(y) + 3 * x;
+        v[0] = p[0]; v[1] = p[1]; v[2] = p[2];
+    }
+};
+
+struct SinCityTap {
+    const cv::Mat& src;
+    inline void operator()(int x, int y, int v[3]) const {
+        const uint8_t* p = src.ptr<uint8_t>(y) + 3 * x;
+        int b = p[0], g = p[1], r = p[2];
+        if (keepsRed(b, g, r)) {
+            v[0] = b; v[1] = g; v[2] = r;
+        } else {
+            v[0] = v[1] = v[2] = (b * kGrayB + g * kGrayG + r * kGrayR + (1 << (kGrayShift - 1))) >> kGrayShift;
+        }
+    }
+};
+
+struct PixelateTap {
+    const cv::Mat& means;
+    int pixelSize;
+    inline void operator()(int x, int y, int v[3]) const {
+        const uint8_t* p = means.ptr<uint8_t>(y / pixelSize) + 3 * (x / pixelSize);
+        v[0] = p[0]; v[1] = p[1]; v[2] = p[2];
+    }
+};
+
+// cv::warpAffine's fixed-point bilinear remap: coordinates in 1/1024 (AB_BITS), rounded to 1/32
+// (INTER_BITS), weights products of the 5-bit fractions, taps outside the source are black
+const int kAbBits = 10;
+const int kInterBits = 5;
+const int kInterSize = 1 << kInterBits;
+
+// One destination pixel from the source position (X, Y) in 1/32 pixels
+template <typename Tap>
+inline void remapPixel(const Tap& tap, int srcCols, int srcRows, int X, int Y, uint8_t* out) {
+    const int sx = X >> kInterBits, sy = Y >> kInterBits;
+    const int fx = X & (kInterSize - 1), fy = Y & (kInterSize - 1);
+    if (sx >= srcCols || sx + 1 < 0 || sy >= srcRows || sy + 1 < 0) {
+        out[0] = out[1] = out[2] = 0;
+        return;
+    }
+    int v00[3], v01[3], v10[3], v11[3];
+    if ((unsigned)sx < (unsigned)(srcCols - 1) && (unsigned)sy < (unsigned)(srcRows - 1)) {
+        tap(sx, sy, v00); tap(sx + 1, sy, v01);
+        tap(sx, sy + 1, v10); tap(sx + 1, sy + 1, v11);
+    } else {
+        // border: taps outside the source read as black
+        const bool x0In = sx >= 0, x1In = sx + 1 < srcCols, y0In = sy >= 0, y1In = sy + 1 < srcRows;
+        for (int c = 0; c < 3; ++c) v00[c] = v01[c] = v10[c] = v11[c] = 0;
+        if (x0In && y0In) tap(sx, sy, v00);
+        if (x1In && y0In) tap(sx + 1, sy, v01);
+        if (x0In && y1In) tap(sx, sy + 1, v10);
+        if (x1In && y1In) tap(sx + 1, sy + 1, v11);
+    }
+    const int w00 = (kInterSize - fx) * (kInterSize - fy), w01 = fx * (kInterSize - fy);
+    const int w10 = (kInterSize - fx) * fy, w11 = fx * fy;
+    const int half = 1 << (2 * kInterBits - 1);
+    for (int c = 0; c < 3; ++c)
+        out[c] = (uint8_t)((v00[c] * w00 + v01[c] * w01 + v10[c] * w10 + v11[c] * w11 + half) >> (2 * kInterBits));
+}
+
+template <typename Tap>
+void warpRows(const Tap& tap, int srcCols, int srcRows, cv::Mat& dst, const double m[6], bool flipRows, int threads) {
+    const int abScale = 1 << kAbBits;
+    const int roundDelta = abScale / kInterSize / 2;
+    std::vector<int> adelta(dst.cols), bdelta(dst.cols);
+    for (int x = 0; x < dst.cols; ++x) {
+        adelta[x] = cv::saturate_cast<int>(m[0] * x * abScale);
+        bdelta[x] = cv::saturate_cast<int>(m[3] * x * abScale);
+    }
+    forTiles(dst.size(), threads, [&](const cv::Rect& tile) {
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            uint8_t* out = dst.ptr<uint8_t>(flipRows ? dst.rows - 1 - y : y) + 3 * tile.x;
+            const int X0 = cv::saturate_cast<int>((m[1] * y + m[2]) * abScale) + roundDelta;
+            const int Y0 = cv::saturate_cast<int>((m[4] * y + m[5]) * abScale) + roundDelta;
+            for (int x = tile.x; x < tile.x + tile.width; ++x, out += 3)
+                remapPixel(tap, srcCols, srcRows, (X0 + adelta[x]) >> (kAbBits - kInterBits),
+                           (Y0 + bdelta[x]) >> (kAbBits - kInterBits), out);
+        }
+    });
+}
+
+// M maps source to destination like cv::warpAffine's; invert it the way warpAffine does
+void invertAffine(const cv::Mat& M, double m[6]) {
+    cv::Mat A;
+    M.convertTo(A, CV_64F);
+    for (int i = 0; i < 6; ++i) m[i] = A.at<double>(i / 3, i % 3);
+    double D = m[0] * m[4] - m[1] * m[3];
+    D = D != 0 ? 1.0 / D : 0.0;
+    double a11 = m[4] * D, a22 = m[0] * D;
+    m[0] = a11; m[1] *= -D;
+    m[3] *= -D; m[4] = a22;
+    double b1 = -m[0] * m[2] - m[1] * m[5];
+    double b2 = -m[3] * m[2] - m[4] * m[5];
+    m[2] = b1; m[5] = b2;
+}
+
+// Sizes the warp target. dst may be a view of someone else's memory (a GL upload or shared-memory
+// slot); create() would silently swap a heap buffer in for it, so that has to fit already.
+void createTarget(cv::Mat& dst, cv::Size dsize) {
+    CV_Assert(dst.empty() || dst.u || (dst.size() == dsize && dst.type() == CV_8UC3));
+    dst.create(dsize, CV_8UC3);
+}
+
+// Whole-pixel shift: each destination row is a slice of one source row with black either side
+void warpTranslate(const cv::Mat& src, cv::Mat& dst, int dx, int dy, int threads) {
+    const int x0 = std::max(0, -dx), x1 = std::min(dst.cols, src.cols - dx);
+    forTiles(dst.size(), threads, [&](const cv::Rect& tile) {
+        // the tile's columns that have a source pixel: [in0, in1)
+        const int c0 = tile.x, c1 = tile.x + tile.width;
+        const int in0 = std::min(std::max(x0, c0), c1), in1 = std::max(std::min(x1, c1), in0);
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            uint8_t* out = dst.ptr<uint8_t>(y);
+            const int sy = y + dy;
+            if (sy < 0 || sy >= src.rows) {
+                std::memset(out + 3 * c0, 0, (size_t)(c1 - c0) * 3);
+                continue;
+            }
+            std::memset(out + 3 * c0, 0, (size_t)(in0 - c0) * 3);
+            if (in1 > in0) std::memcpy(out + 3 * in0, src.ptr<uint8_t>(sy) + 3 * (in0 + dx), (size_t)(in1 - in0) * 3);
+            std::memset(out + 3 * in1, 0, (size_t)(c1 - in1) * 3);
+        }
+    });
+}
+
+// Axis-aligned scale: x only depends on the column and y on the row, so the bilinear sum splits
+// into a vertical blend of two source rows (kept at 1/32 precision) and a horizontal one. Same
+// fixed-point coordinates and rounding as warpRows.
+void warpScale(const cv::Mat& src, cv::Mat& dst, const double m[6], int threads) {
+    const int abScale = 1 << kAbBits;
+    const int roundDelta = abScale / kInterSize / 2;
+    const int X0 = cv::saturate_cast<int>(m[2] * abScale) + roundDelta;
+    std::vector<int> colX(dst.cols), colF(dst.cols);
+    for (int x = 0; x < dst.cols; ++x) {
+        const int X = (X0 + cv::saturate_cast<int>(m[0] * x * abScale)) >> (kAbBits - kInterBits);
+        colX[x] = X >> kInterBits;
+        colF[x] = X & (kInterSize - 1);
+    }
+
+    forTiles(dst.size(), threads, [&](const cv::Rect& tile) {
+        const int xEnd = tile.x + tile.width;
+        // source columns the tile reads
+        int lo = src.cols, hi = -1;
+        for (int x = tile.x; x < xEnd; ++x) {
+            lo = std::min(lo, colX[x]);
+            hi = std::max(hi, colX[x] + 1);
+        }
+        lo = std::max(lo, 0);
+        hi = std::min(hi, src.cols - 1);
+        thread_local std::vector<int16_t> blend;
+        if (blend.size() < (size_t)src.cols * 3) blend.resize((size_t)src.cols * 3);
+
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            uint8_t* out = dst.ptr<uint8_t>(y) + 3 * tile.x;
+            const int Y = (cv::saturate_cast<int>((m[4] * y + m[5]) * abScale) + roundDelta) >> (kAbBits - kInterBits);
+            const int sy = Y >> kInterBits, fy = Y & (kInterSize - 1);
+            if (sy >= src.rows || sy + 1 < 0 || lo > hi) {
+                std::memset(out, 0, (size_t)tile.width * 3);
+                continue;
+            }
+            // rows outside the source are black: a zero weight drops them
+            const uint8_t* a = src.ptr<uint8_t>(std::max(sy, 0));
+            const uint8_t* b = src.ptr<uint8_t>(std::min(sy + 1, src.rows - 1));
+            const int wa = sy >= 0 ? kInterSize - fy : 0;
+            const int wb = sy + 1 < src.rows ? fy : 0;
+            int i = lo * 3;
+            const int end = (hi + 1) * 3;
+#ifdef CPUFILTERS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i va16 = _mm_set1_epi16((short)wa), vb16 = _mm_set1_epi16((short)wb);
+            for (; i + 16 <= end; i += 16) {
+                __m128i ra = _mm_loadu_si128((const __m128i*)(a + i));
+                __m128i rb = _mm_loadu_si128((const __m128i*)(b + i));
+                _mm_storeu_si128((__m128i*)(blend.data() + i),
+                                 _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(ra, zero), va16),
+                                               _mm_mullo_epi16(_mm_unpacklo_epi8(rb, zero), vb16)));
+                _mm_storeu_si128((__m128i*)(blend.data() + i + 8),
+                                 _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(ra, zero), va16),
+                                               _mm_mullo_epi16(_mm_unpackhi_epi8(rb, zero), vb16)));
+            }
+#endif
+            for (; i < end; ++i) blend[i] = (int16_t)(a[i] * wa + b[i] * wb);
+
+            const int half = 1 << (2 * kInterBits - 1);
+            for (int x = tile.x; x < xEnd; ++x, out += 3) {
+                const int sx = colX[x], fx = colF[x];
+                const int w0 = sx >= 0 && sx < src.cols ? kInterSize - fx : 0;
+                const int w1 = sx + 1 >= 0 && sx + 1 < src.cols ? fx : 0;
+                if (w0 == 0 && w1 == 0) {
+                    out[0] = out[1] = out[2] = 0;
+                    continue;
+                }
+                const int16_t* p0 = blend.data() + 3 * std::max(sx, lo);
+                const int16_t* p1 = blend.data() + 3 * std::min(sx + 1, hi);
+                for (int c = 0; c < 3; ++c) out[c] = (uint8_t)((p0[c] * w0 + p1[c] * w1 + half) >> (2 * kInterBits));
+            }
+        }
+    });
+}
+
+#ifdef CPUFILTERS_SSE2
+// One bilinear pixel from two 8-byte loads (taps sx and sx + 1 plus two spare bytes) per row:
+// horizontal blend in 16 bits, then the vertical one with pmaddwd and warpRows's rounding
+inline void bilinearPixelSSE2(const uint8_t* r0, const uint8_t* r1, int fx, int fy, uint8_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wx0 = _mm_set1_epi16((short)(kInterSize - fx)), wx1 = _mm_set1_epi16((short)fx);
+    __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)r0), zero);
+    __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)r1), zero);
+    __m128i ha = _mm_add_epi16(_mm_mullo_epi16(a, wx0), _mm_mullo_epi16(_mm_srli_si128(a, 6), wx1));
+    __m128i hb = _mm_add_epi16(_mm_mullo_epi16(b, wx0), _mm_mullo_epi16(_mm_srli_si128(b, 6), wx1));
+    __m128i v = _mm_madd_epi16(_mm_unpacklo_epi16(ha, hb), _mm_set1_epi32((fy << 16) | (kInterSize - fy)));
+    v = _mm_srli_epi32(_mm_add_epi32(v, _mm_set1_epi32(1 << (2 * kInterBits - 1))), 2 * kInterBits);
+    v = _mm_packus_epi16(_mm_packs_epi32(v, v), zero);
+    const uint32_t px = (uint32_t)_mm_cvtsi128_si32(v);
+    out[0] = (uint8_t)px; out[1] = (uint8_t)(px >> 8); out[2] = (uint8_t)(px >> 16);
+}
+#endif
+
+// Rotation, shear or anything else: warpRows with a plain tap, except that taps well inside the
+// source go through the SSE2 pixel. Its 8-byte loads stay inside the image for sx <= cols - 3.
+void warpGeneral(const cv::Mat& src, cv::Mat& dst, const double m[6], int threads) {
+#ifdef CPUFILTERS_SSE2
+    const int abScale = 1 << kAbBits;
+    const int roundDelta = abScale / kInterSize / 2;
+    std::vector<int> adelta(dst.cols), bdelta(dst.cols);
+    for (int x = 0; x < dst.cols; ++x) {
+        adelta[x] = cv::saturate_cast<int>(m[0] * x * abScale);
+        bdelta[x] = cv::saturate_cast<int>(m[3] * x * abScale);
+    }
+    const size_t step = src.step;
+    const PlainTap tap{ src };
+    forTiles(dst.size(), threads, [&](const cv::Rect& tile) {
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            uint8_t* out = dst.ptr<uint8_t>(y) + 3 * tile.x;
+            const int X0 = cv::saturate_cast<int>((m[1] * y + m[2]) * abScale) + roundDelta;
+            const int Y0 = cv::saturate_cast<int>((m[4] * y + m[5]) * abScale) + roundDelta;
+            for (int x = tile.x; x < tile.x + tile.width; ++x, out += 3) {
+                const int X = (X0 + adelta[x]) >> (kAbBits - kInterBits);
+                const int Y = (Y0 + bdelta[x]) >> (kAbBits - kInterBits);
+                const int sx = X >> kInterBits, sy = Y >> kInterBits;
+                if (sx >= 0 && sx <= src.cols - 3 && sy >= 0 && sy < src.rows - 1) {
+                    const uint8_t* p = src.ptr<uint8_t>(sy) + 3 * sx;
+                    bilinearPixelSSE2(p, p + step, X & (kInterSize - 1), Y & (kInterSize - 1), out);
+                } else {
+                    remapPixel(tap, src.cols, src.rows, X, Y, out);
+                }
+            }
+        }
+    });
+#else
+    warpRows(PlainTap{ src }, src.cols, src.rows, dst, m, false, threads);
+#endif
+}
+
+SimdLevel detectSimd() {
+#if defined(CPUFILTERS_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool ssse3 = (info[2] & (1 << 9)) != 0;
+    // AVX2 also needs the OS to save the YMM registers
+    const bool osYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osYmm) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    return avx2 ? SIMD_AVX2 : (ssse3 ? SIMD_SSSE3 : SIMD_NONE);
+#elif defined(CPUFILTERS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("ssse3")) return SIMD_SSSE3;
+    return SIMD_NONE;
+#else
+    return SIMD_NONE;
+#endif
+}
+
+}
+
+SimdLevel simdLevel() {
+    static const SimdLevel level = detectSimd();
+    return level;
+}
+
+const char* simdName(SimdLevel level) {
+    return level == SIMD_AVX2 ? "avx2" : (level == SIMD_SSSE3 ? "ssse3" : "scalar");
+}
+
 void pixelate(cv::Mat& src, cv::Mat& dst, int pixelSize) {
+    pixelate(src, dst, pixelSize, simdLevel());
+}
+
+void pixelate(const cv::Mat& src, cv::Mat& dst, int pixelSize, SimdLevel simd, int threads) {
+    CV_Assert(src.type() == CV_8UC3 && pixelSize > 0);
+    cv::Mat means;
+    blockMeans(src, pixelSize, std::min(simd, simdLevel()), threads, means);
+    // src is read completely before dst is written, so src may also be dst
+    dst.create(src.rows, src.cols, CV_8UC3);
+    const int rowBytes = src.cols * 3;
+    forRowBands(means.rows, WorkStealingPool::shared().tileHeight() / pixelSize, threads, [&](const cv::Range& range) {
+        std::vector<uint8_t> colors(rowBytes);
+        for (int by = range.start; by < range.end; ++by) {
+            const uint8_t* mean = means.ptr<uint8_t>(by);
+            for (int x = 0; x < src.cols; ++x)
+                for (int c = 0; c < 3; ++c) colors[3 * x + c] = mean[3 * (x / pixelSize) + c];
+            const int y1 = std::min((by + 1) * pixelSize, src.rows);
+            for (int y = by * pixelSize; y < y1; ++y) memcpy(dst.ptr<uint8_t>(y), colors.data(), rowBytes);
+        }
+    });
+}
+
+void pixelateReference(const cv::Mat& src, cv::Mat& dst, int pixelSize) {
     dst = src.clone();
     for (int y = 0; y < src.rows; y += pixelSize) {
         for (int x = 0; x < src.cols; x += pixelSize) {
@@ -16,6 +610,29 @@ void pixelate(cv::Mat& src, cv::Mat& dst, int pixelSize) {
 }
 
 void sinCity(cv::Mat& src, cv::Mat& dst) {
+    sinCity(src, dst, simdLevel());
+}
+
+void sinCity(const cv::Mat& src, cv::Mat& dst, SimdLevel simd, int threads) {
+    CV_Assert(src.type() == CV_8UC3);
+    simd = std::min(simd, simdLevel());
+    dst.create(src.rows, src.cols, CV_8UC3);
+    // every output pixel only depends on its own input pixel, so src may also be dst
+    forTiles(src.size(), threads, [&](const cv::Rect& tile) {
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            const uint8_t* s = src.ptr<uint8_t>(y) + 3 * tile.x;
+            uint8_t* d = dst.ptr<uint8_t>(y) + 3 * tile.x;
+            int x = 0;
+#ifdef CPUFILTERS_X86
+            if (simd == SIMD_AVX2) x = sinCityPixelsAVX2(s, d, tile.width);
+            if (simd >= SIMD_SSSE3) x += sinCityPixelsSSSE3(s + 3 * x, d + 3 * x, tile.width - x);
+#endif
+            sinCityPixels(s + 3 * x, d + 3 * x, tile.width - x);
+        }
+    });
+}
+
+void sinCityReference(const cv::Mat& src, cv::Mat& dst) {
     cv::Mat gray;
     cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
     cv::cvtColor(gray, dst, cv::COLOR_GRAY2BGR);
@@ -29,4 +646,107 @@ void sinCity(cv::Mat& src, cv::Mat& dst) {
     }
 }
 
+void boxDownsample2x(const cv::Mat& src, cv::Mat& dst) {
+    CV_Assert(src.type() == CV_8UC3 && src.data != dst.data);
+    dst.create(src.rows / 2, src.cols / 2, CV_8UC3);
+    const int rowBytes = src.cols * 3;
+    forRowBands(dst.rows, WorkStealingPool::shared().tileHeight(), 0, [&](const cv::Range& rows) {
+        std::vector<uint16_t> sums(rowBytes + 16);
+        for (int y = rows.start; y < rows.end; ++y) {
+            const uint8_t* a = src.ptr<uint8_t>(2 * y);
+            const uint8_t* b = src.ptr<uint8_t>(2 * y + 1);
+            // vertical pairs, 16 bytes at a time widened to 16 bits
+            int i = 0;
+#ifdef CPUFILTERS_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= rowBytes; i += 16) {
+                __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+                __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+                _mm_storeu_si128((__m128i*)(sums.data() + i),
+                                 _mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero)));
+                _mm_storeu_si128((__m128i*)(sums.data() + i + 8),
+                                 _mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero)));
+            }
+#endif
+            for (; i < rowBytes; ++i) sums[i] = (uint16_t)(a[i] + b[i]);
+            // horizontal pairs: channel c of output pixel x comes from bytes 6x + c and 6x + 3 + c
+            uint8_t* out = dst.ptr<uint8_t>(y);
+            for (int x = 0; x < dst.cols; ++x) {
+                const uint16_t* s = sums.data() + 6 * x;
+                out[3 * x + 0] = (uint8_t)((s[0] + s[3] + 2) >> 2);
+                out[3 * x + 1] = (uint8_t)((s[1] + s[4] + 2) >> 2);
+                out[3 * x + 2] = (uint8_t)((s[2] + s[5] + 2) >> 2);
+            }
+        }
+    });
+}
+
+WarpClass classifyWarp(const cv::Mat& M) {
+    CV_Assert(M.rows == 2 && M.cols == 3);
+    cv::Mat A;
+    M.convertTo(A, CV_64F);
+    const double* r0 = A.ptr<double>(0);
+    const double* r1 = A.ptr<double>(1);
+    if (r0[1] != 0 || r1[0] != 0 || r0[0] == 0 || r1[1] == 0) return WARP_GENERAL;
+    if (r0[0] != 1 || r1[1] != 1) return WARP_SCALE;
+    // a shift this close to whole pixels still rounds to zero fractions in warpAffine's 1/32 grid
+    const double eps = 1e-3;
+    const double tx = std::floor(r0[2] + 0.5), ty = std::floor(r1[2] + 0.5);
+    if (std::fabs(r0[2] - tx) > eps || std::fabs(r1[2] - ty) > eps) return WARP_SCALE;
+    return tx == 0 && ty == 0 ? WARP_IDENTITY : WARP_TRANSLATE;
+}
+
+const char* warpClassName(WarpClass c) {
+    switch (c) {
+        case WARP_IDENTITY: return "identity";
+        case WARP_TRANSLATE: return "translate";
+        case WARP_SCALE: return "scale";
+        default: return "general";
+    }
+}
+
+WarpClass warp(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize, int threads) {
+    const WarpClass c = classifyWarp(M);
+    warp(src, dst, M, dsize, c, threads);
+    return c;
+}
+
+void warp(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize, WarpClass kernel, int threads) {
+    CV_Assert(src.type() == CV_8UC3 && kernel >= classifyWarp(M));
+    CV_Assert(src.data != dst.data || dst.empty());
+    createTarget(dst, dsize);
+    if (kernel == WARP_IDENTITY && src.size() == dsize) {
+        src.copyTo(dst);
+        return;
+    }
+    double m[6];
+    invertAffine(M, m);
+    // an identity into a bigger target is a zero shift with black filled in
+    if (kernel <= WARP_TRANSLATE)
+        warpTranslate(src, dst, (int)std::floor(m[2] + 0.5), (int)std::floor(m[5] + 0.5), threads);
+    else if (kernel == WARP_SCALE)
+        warpScale(src, dst, m, threads);
+    else
+        warpGeneral(src, dst, m, threads);
+}
+
+void filterWarp(const cv::Mat& src, cv::Mat& dst, cv::Size dsize, Filter filter, const cv::Mat& M, bool flipRows,
+                int pixelSize, int threads) {
+    CV_Assert(src.type() == CV_8UC3 && M.rows == 2 && M.cols == 3 && pixelSize > 0);
+    CV_Assert(src.data != dst.data || dst.empty());
+    double m[6];
+    invertAffine(M, m);
+
+    createTarget(dst, dsize);
+    if (filter == PIXELATE) {
+        cv::Mat means;
+        blockMeans(src, pixelSize, simdLevel(), threads, means);
+        warpRows(PixelateTap{ means, pixelSize }, src.cols, src.rows, dst, m, flipRows, threads);
+    } else if (filter == SINCITY) {
+        warpRows(SinCityTap{ src }, src.cols, src.rows, dst, m, flipRows, threads);
+    } else {
+        warpRows(PlainTap{ src }, src.cols, src.rows, dst, m, flipRows, threads);
+    }
+}
+
 }
@@ -3,10 +3,69 @@
 
 namespace CPUFilters {
 
-    // Simple pixelation filter using block averaging
+    // Vector instruction sets the kernels can use, best last
+    enum SimdLevel { SIMD_NONE = 0, SIMD_SSSE3 = 1, SIMD_AVX2 = 2 };
+
+    // Best level this CPU supports, detected once
+    SimdLevel simdLevel();
+    const char* simdName(SimdLevel level);
+
+    // All kernels run on WorkStealingPool::shared(), split into its tiles (or bands of rows about a
+    // tile high). A threads argument caps the participating threads; 0 = the pool's active count.
+
+    // Simple pixelation filter using block averaging. Column sums of each block row are
+    // accumulated with SIMD, then every block's mean is written straight into dst; bands of block
+    // rows run on the pool. Any block size, output identical to pixelateReference.
     void pixelate(cv::Mat& src, cv::Mat& dst, int pixelSize = 10);
+    // Same with the instruction set capped at simd (SIMD_SSSE3 runs the SSE2 kernel) and at most
+    // threads threads
+    void pixelate(const cv::Mat& src, cv::Mat& dst, int pixelSize, SimdLevel simd, int threads = 0);
+    // The original version: a copy of src, then cv::mean and a filled cv::rectangle per block
+    void pixelateReference(const cv::Mat& src, cv::Mat& dst, int pixelSize = 10);
 
-    // Sin City filter: grayscale + keep red tones
+    // Sin City filter: grayscale + keep red tones. One pass over the frame with the best SIMD
+    // kernel, tile by tile on the pool; the output matches sinCityReference exactly.
     void sinCity(cv::Mat& src, cv::Mat& dst);
+    // Same with the instruction set capped at simd and at most threads threads
+    void sinCity(const cv::Mat& src, cv::Mat& dst, SimdLevel simd, int threads = 0);
+    // The original three passes: cvtColor to gray and back, then the red pixels copied over
+    void sinCityReference(const cv::Mat& src, cv::Mat& dst);
+
+    // Filters filterWarp can apply while it samples
+    enum Filter { NONE = 0, PIXELATE = 1, SINCITY = 2 };
+
+    // Filter, affine warp and vertical flip in one pass. Every destination pixel is mapped back
+    // through the inverse of M (the 2x3 matrix cv::warpAffine takes, e.g. from
+    // getRotationMatrix2D), and the filter is applied at the four source taps, which are then
+    // interpolated with warpAffine's fixed-point bilinear weights. So no filtered or warped
+    // frame is written in between, and the result is what filter, warpAffine (black border) and
+    // cv::flip(.., 0) produce. dst gets size dsize and must not share src's pixels; when it is
+    // a view of external memory (an upload slot) it must already have that size. pixelate reads
+    // only the block means after one pass over src.
+    void filterWarp(const cv::Mat& src, cv::Mat& dst, cv::Size dsize, Filter filter, const cv::Mat& M,
+                    bool flipRows, int pixelSize = 10, int threads = 0);
+
+    // Affine warps the dispatcher tells apart, each a special case of the next
+    enum WarpClass { WARP_IDENTITY = 0, WARP_TRANSLATE = 1, WARP_SCALE = 2, WARP_GENERAL = 3 };
+
+    // Identity, a whole-pixel shift (within 1/1000 of a pixel), an axis-aligned scale with any
+    // translation, or general (rotation, shear, singular)
+    WarpClass classifyWarp(const cv::Mat& M);
+    const char* warpClassName(WarpClass c);
+
+    // cv::warpAffine(src, dst, M, dsize) with bilinear interpolation and a black border,
+    // picking the cheapest kernel for M: a copy, row slices with black fill, a separable
+    // vertical-then-horizontal blend, or the fixed-point bilinear remap with an SSE2 inner pixel.
+    // Tiles run on the pool and all kernels give warpAffine's fixed-point result. Returns
+    // the class used. dst must not share src's pixels; a view of external memory (an upload or
+    // shared-memory slot) must already be dsize, it is never reallocated. src may be smaller
+    // than dsize, e.g. pre-shrunk for a minifying M.
+    WarpClass warp(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize, int threads = 0);
+    // Same with the kernel forced; it must cover M, i.e. kernel >= classifyWarp(M)
+    void warp(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize, WarpClass kernel, int threads = 0);
+
+    // Halves a CV_8UC3 image with a 2x2 box filter, (a+b+c+d+2)/4 per channel; an odd last
+    // row or column is dropped. Rows are summed with SSE2 where available.
+    void boxDownsample2x(const cv::Mat& src, cv::Mat& dst);
 
 }
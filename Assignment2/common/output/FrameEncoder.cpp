@@ -0,0 +1,129 @@
+#include "FrameEncoder.hpp"
+
+#include <chrono>
+#include <iostream>
+
+static bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+FrameEncoder::FrameEncoder(size_t maxQueued)
+    : m_fps(30.0), m_maxQueued(maxQueued < 1 ? 1 : maxQueued), m_running(false), m_stopping(false) {}
+
+FrameEncoder::~FrameEncoder() {
+    close();
+}
+
+bool FrameEncoder::open(const std::string& path, double fps) {
+    close();
+    if (path.empty()) return false;
+    m_path = path;
+    m_fps = fps > 0.0 ? fps : 30.0;
+    m_size = cv::Size();
+    m_stats = EncoderStats();
+    m_stopping = false;
+    m_running = true;
+    m_thread = std::thread(&FrameEncoder::run, this);
+    return true;
+}
+
+void FrameEncoder::close() {
+    if (!m_running) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_running = false;
+
+    if (m_video.isOpened()) m_video.release();
+    if (m_raw.isOpen()) m_raw.close();
+    std::cout << "[RECORD] " << m_path << ": " << m_stats.encoded << " frames written, "
+              << m_stats.dropped << " dropped\n";
+}
+
+bool FrameEncoder::submit(const cv::Mat& frame, int64_t captureTimeNs, bool bottomUp) {
+    if (!m_running || frame.type() != CV_8UC3) return false;
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.submitted;
+        if (m_queue.size() >= m_maxQueued) {
+            ++m_stats.dropped;
+            return false;
+        }
+        if (!m_spare.empty()) {
+            job.frame = std::move(m_spare.back());
+            m_spare.pop_back();
+        }
+    }
+    // copy outside the lock; copyTo keeps the recycled allocation when the size matches
+    frame.copyTo(job.frame);
+    job.captureTimeNs = captureTimeNs;
+    job.bottomUp = bottomUp;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+EncoderStats FrameEncoder::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void FrameEncoder::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty()) break;     // stopping and drained
+
+        Job job = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        write(job);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        lock.lock();
+        m_stats.encodeMs += ms;
+        m_spare.push_back(std::move(job.frame));
+    }
+}
+
+void FrameEncoder::write(Job& job) {
+    const cv::Mat* frame = &job.frame;
+    if (job.bottomUp) {
+        cv::flip(job.frame, m_flipped, 0);
+        frame = &m_flipped;
+    }
+
+    if (m_size.area() == 0) {
+        m_size = frame->size();
+        bool ok;
+        if (endsWith(m_path, ".raw")) {
+            ok = m_raw.open(m_path);
+        } else {
+            int fourcc = endsWith(m_path, ".avi") ? cv::VideoWriter::fourcc('M','J','P','G')
+                                                  : cv::VideoWriter::fourcc('m','p','4','v');
+            ok = m_video.open(m_path, fourcc, m_fps, m_size);
+        }
+        if (!ok) std::cerr << "[RECORD] Cannot open " << m_path << " for writing\n";
+    }
+    if (frame->size() != m_size) return;
+
+    bool written = false;
+    if (m_raw.isOpen()) written = m_raw.append(*frame, job.captureTimeNs);
+    else if (m_video.isOpened()) {
+        m_video.write(*frame);
+        written = true;
+    }
+    if (written) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.encoded;
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * FrameEncoder.hpp
+ *
+ *  Background thread that writes frames to a video file or a raw recording.
+ *
+ */
+#ifndef FRAMEENCODER_HPP
+#define FRAMEENCODER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include <common/capture/RawFrameFile.hpp>
+
+//! EncoderStats
+/*! Counters since open(). */
+struct EncoderStats {
+    uint64_t submitted = 0;
+    uint64_t encoded = 0;
+    uint64_t dropped = 0;       //!< rejected by submit() because the queue was full
+    double encodeMs = 0.0;      //!< total time spent writing on the encoder thread
+};
+
+//!  FrameEncoder.
+/*!
+ submit() copies a frame into a recycled buffer and queues it; the encoder thread flips it if
+ needed and writes it. A path ending in .raw is written with RawFrameWriter, anything else with
+ cv::VideoWriter (MJPG for .avi, mp4v otherwise). The output is created at the size of the first
+ frame; frames of another size are skipped. submit() never blocks: when the encoder falls more
+ than maxQueued frames behind, new frames are dropped.
+ */
+class FrameEncoder {
+public:
+    FrameEncoder(size_t maxQueued = 4);
+    //! Destructor
+    /*! Calls close(). */
+    ~FrameEncoder();
+
+    //! open
+    /*! Starts the encoder thread. fps is stored in video containers. */
+    bool open(const std::string& path, double fps);
+    //! close
+    /*! Writes everything still queued, then stops the thread and closes the file. */
+    void close();
+    bool isOpen() const { return m_running; }
+
+    //! submit
+    /*! Queues a CV_8UC3 copy of frame. bottomUp frames (GL readback) are flipped on the encoder thread. */
+    bool submit(const cv::Mat& frame, int64_t captureTimeNs, bool bottomUp);
+
+    EncoderStats stats() const;
+    const std::string& path() const { return m_path; }
+
+private:
+    struct Job {
+        cv::Mat frame;
+        int64_t captureTimeNs;
+        bool bottomUp;
+    };
+
+    void run();
+    //! write
+    /*! Encoder thread only. Opens the output on the first frame. */
+    void write(Job& job);
+
+    std::string m_path;
+    double m_fps;
+    size_t m_maxQueued;
+    bool m_running;
+    bool m_stopping;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Job> m_queue;
+    std::vector<cv::Mat> m_spare;       //!< buffers handed back by the encoder thread
+
+    // encoder thread
+    cv::VideoWriter m_video;
+    RawFrameWriter m_raw;
+    cv::Size m_size;
+    cv::Mat m_flipped;
+
+    EncoderStats m_stats;
+};
+
+#endif
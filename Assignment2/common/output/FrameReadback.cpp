@@ -0,0 +1,88 @@
+#include <glad/gl.h>
+
+#include "FrameReadback.hpp"
+
+#include <chrono>
+
+static double msSince(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+FrameReadback::FrameReadback(int depth)
+    : m_buffers(depth < 2 ? 2 : depth), m_width(0), m_height(0), m_next(0), m_pending(0) {}
+
+FrameReadback::~FrameReadback() {
+    for (Buffer& b : m_buffers) {
+        if (b.fence) glDeleteSync((GLsync)b.fence);
+        if (b.pbo) glDeleteBuffers(1, &b.pbo);
+    }
+}
+
+void FrameReadback::allocate(int width, int height) {
+    const GLsizeiptr bytes = (GLsizeiptr)width * height * 3;
+    for (Buffer& b : m_buffers) {
+        if (!b.pbo) glGenBuffers(1, &b.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, b.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_width = width;
+    m_height = height;
+}
+
+bool FrameReadback::queue(int width, int height, int64_t captureTimeNs) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (width != m_width || height != m_height) {
+        // a size change needs new buffers, drop what is still in flight at the old size
+        collect(Sink(), true);
+        allocate(width, height);
+    }
+    if (m_pending == (int)m_buffers.size()) {
+        ++m_stats.skipped;
+        m_stats.queueMs += msSince(start);
+        return false;
+    }
+
+    Buffer& b = m_buffers[m_next];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, b.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, nullptr);   // into the PBO, returns at once
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    b.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    b.captureTimeNs = captureTimeNs;
+
+    m_next = (m_next + 1) % (int)m_buffers.size();
+    ++m_pending;
+    ++m_stats.queued;
+    m_stats.queueMs += msSince(start);
+    return true;
+}
+
+int FrameReadback::collect(const Sink& sink, bool wait) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const int n = (int)m_buffers.size();
+    int delivered = 0;
+    while (m_pending > 0) {
+        Buffer& b = m_buffers[(m_next - m_pending + n) % n];
+        // flush on the first check so the fence is guaranteed to signal eventually
+        GLuint64 timeout = wait ? 1000000000ull : 0;
+        GLenum state = glClientWaitSync((GLsync)b.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (state == GL_TIMEOUT_EXPIRED) break;     // oldest not done yet, so nothing newer is either
+        glDeleteSync((GLsync)b.fence);
+        b.fence = nullptr;
+        --m_pending;
+        if (state == GL_WAIT_FAILED || !sink) continue;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, b.pbo);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)m_width * m_height * 3, GL_MAP_READ_BIT);
+        if (data) {
+            sink(cv::Mat(m_height, m_width, CV_8UC3, data), b.captureTimeNs);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            ++delivered;
+            ++m_stats.delivered;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    m_stats.collectMs += msSince(start);
+    return delivered;
+}
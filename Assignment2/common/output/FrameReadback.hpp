@@ -0,0 +1,73 @@
+/*
+ * FrameReadback.hpp
+ *
+ *  Asynchronous framebuffer readback through a ring of pixel buffer objects.
+ *
+ */
+#ifndef FRAMEREADBACK_HPP
+#define FRAMEREADBACK_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+//! ReadbackStats
+/*! Counters since construction. Times are spent on the calling (GL) thread. */
+struct ReadbackStats {
+    uint64_t queued = 0;
+    uint64_t delivered = 0;
+    uint64_t skipped = 0;       //!< frames not read back because every buffer was still in flight
+    double queueMs = 0.0;       //!< total time in queue()
+    double collectMs = 0.0;     //!< total time in collect(), including the sink
+};
+
+//!  FrameReadback.
+/*!
+ queue() issues glReadPixels of the bound read framebuffer into the next PBO and inserts a fence,
+ so the call returns without waiting for the GPU. collect() maps only the buffers whose fence has
+ signalled and hands their pixels to a sink, oldest first. If all buffers are still in flight
+ queue() skips the frame rather than stalling the render loop. Needs a current GL context for
+ every call, including destruction.
+ */
+class FrameReadback {
+public:
+    //! Sink
+    /*! Receives a BGR view of the mapped buffer, rows bottom-up. Only valid during the call. */
+    typedef std::function<void(const cv::Mat& frame, int64_t captureTimeNs)> Sink;
+
+    FrameReadback(int depth = 3);
+    ~FrameReadback();
+
+    //! queue
+    /*! Starts reading (0, 0, width, height) of the current read framebuffer. False if skipped. */
+    bool queue(int width, int height, int64_t captureTimeNs);
+    //! collect
+    /*! Delivers every finished readback in order; with wait=true also waits for the rest. */
+    int collect(const Sink& sink, bool wait = false);
+
+    int depth() const { return (int)m_buffers.size(); }
+    int pending() const { return m_pending; }
+    ReadbackStats stats() const { return m_stats; }
+
+private:
+    struct Buffer {
+        unsigned int pbo = 0;
+        void* fence = nullptr;      //!< GLsync of the read in flight
+        int64_t captureTimeNs = 0;
+    };
+
+    //! allocate
+    /*! (Re)sizes every PBO for frames of the given size. Only called with nothing in flight. */
+    void allocate(int width, int height);
+
+    std::vector<Buffer> m_buffers;
+    int m_width;
+    int m_height;
+    int m_next;         //!< buffer the next queue() writes
+    int m_pending;      //!< reads in flight, the oldest is m_next - m_pending
+    ReadbackStats m_stats;
+};
+
+#endif
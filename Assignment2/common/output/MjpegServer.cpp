@@ -0,0 +1,356 @@
+#include "MjpegServer.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+static void closeSocket(socket_t s) { closesocket(s); }
+static const int kShutdownBoth = SD_BOTH;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+static const socket_t INVALID_SOCKET = -1;
+static void closeSocket(socket_t s) { ::close(s); }
+static const int kShutdownBoth = SHUT_RDWR;
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0      // a viewer closing the connection must not raise SIGPIPE
+#endif
+
+static bool sendAll(socket_t s, const char* data, size_t size) {
+    while (size > 0) {
+        int n = (int)send(s, data, (int)size, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool sendAll(socket_t s, const std::string& text) {
+    return sendAll(s, text.data(), text.size());
+}
+
+MjpegServer::MjpegServer()
+    : m_port(0), m_quality(80), m_maxInFlight(4), m_running(false), m_stopping(false),
+      m_listenSocket((intptr_t)INVALID_SOCKET), m_clientCount(0), m_encoding(0), m_submitted(0),
+      m_latestSequence(0), m_encoded(0), m_skipped(0), m_encodeMs(0.0) {}
+
+MjpegServer::~MjpegServer() {
+    stop();
+}
+
+bool MjpegServer::start(int port, int encodeThreads, int quality) {
+    stop();
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET) return false;
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&yes, sizeof(yes));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(s, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 8) != 0) {
+        std::cerr << "[HTTP] Cannot listen on port " << port << "\n";
+        closeSocket(s);
+        return false;
+    }
+
+    m_port = port;
+    m_quality = quality;
+    if (encodeThreads < 1) encodeThreads = 1;
+    m_maxInFlight = (size_t)(2 * encodeThreads);
+    m_listenSocket = (intptr_t)s;
+    m_stopping = false;
+    m_running = true;
+    m_submitted = m_latestSequence = m_encoded = m_skipped = 0;
+    m_encodeMs = 0.0;
+    m_latest.reset();
+
+    for (int i = 0; i < encodeThreads; ++i) m_encoders.emplace_back(&MjpegServer::encodeLoop, this);
+    m_acceptThread = std::thread(&MjpegServer::acceptLoop, this);
+    std::cout << "[HTTP] Serving MJPEG on http://<host>:" << port << "/stream (" << encodeThreads
+              << " encoder threads, quality " << quality << ")\n";
+    return true;
+}
+
+void MjpegServer::stop() {
+    if (!m_running) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        // unblock sender threads stuck in send()
+        for (auto& c : m_clients)
+            if (!c->finished) shutdown((socket_t)c->socket, kShutdownBoth);
+    }
+    m_jobReady.notify_all();
+    m_frameReady.notify_all();
+
+    m_acceptThread.join();
+    for (std::thread& t : m_encoders) t.join();
+    m_encoders.clear();
+    reapClients(true);
+    closeSocket((socket_t)m_listenSocket);
+    m_listenSocket = (intptr_t)INVALID_SOCKET;
+    m_jobs.clear();
+    m_running = false;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool MjpegServer::submit(const cv::Mat& frame, int64_t captureTimeNs, bool bottomUp) {
+    (void)captureTimeNs;
+    if (!m_running || m_clientCount.load() == 0 || frame.empty()) return false;
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_jobs.size() + (size_t)m_encoding >= m_maxInFlight) {
+            ++m_skipped;
+            return false;
+        }
+        if (!m_spare.empty()) {
+            job.frame = std::move(m_spare.back());
+            m_spare.pop_back();
+        }
+        job.sequence = ++m_submitted;
+    }
+    frame.copyTo(job.frame);
+    job.bottomUp = bottomUp;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_jobReady.notify_one();
+    return true;
+}
+
+void MjpegServer::encodeLoop() {
+    const std::vector<int> params = { cv::IMWRITE_JPEG_QUALITY, m_quality };
+    cv::Mat flipped;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_jobReady.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+        if (m_stopping) break;
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        ++m_encoding;
+        lock.unlock();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        const cv::Mat* image = &job.frame;
+        if (job.bottomUp) {
+            cv::flip(job.frame, flipped, 0);
+            image = &flipped;
+        }
+        auto jpeg = std::make_shared<Jpeg>();
+        bool ok = cv::imencode(".jpg", *image, jpeg->data, params);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        lock.lock();
+        --m_encoding;
+        m_encodeMs += ms;
+        ++m_encoded;
+        // encoders finish out of order; a result older than what is already out is useless
+        if (ok && job.sequence > m_latestSequence) {
+            jpeg->index = m_latest ? m_latest->index + 1 : 1;
+            m_latest = jpeg;
+            m_latestSequence = job.sequence;
+            m_frameReady.notify_all();
+        }
+        m_spare.push_back(std::move(job.frame));
+    }
+}
+
+void MjpegServer::acceptLoop() {
+    const socket_t listenSocket = (socket_t)m_listenSocket;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) break;
+        }
+        reapClients(false);
+
+        // poll so stop() does not depend on closing a socket under a blocked accept()
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listenSocket, &readable);
+        timeval timeout = { 0, 200000 };
+        if (select((int)listenSocket + 1, &readable, nullptr, nullptr, &timeout) <= 0) continue;
+
+        sockaddr_in addr;
+        socklen_t addrLen = sizeof(addr);
+        socket_t s = accept(listenSocket, (sockaddr*)&addr, &addrLen);
+        if (s == INVALID_SOCKET) continue;
+        int yes = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&yes, sizeof(yes));
+
+        char host[64] = "";
+        inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+        std::unique_ptr<Client> client(new Client());
+        client->socket = (intptr_t)s;
+        client->stats.address = std::string(host) + ":" + std::to_string(ntohs(addr.sin_port));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) {
+            closeSocket(s);
+            break;
+        }
+        Client* c = client.get();
+        m_clients.push_back(std::move(client));
+        c->thread = std::thread(&MjpegServer::serveClient, this, c);
+    }
+}
+
+void MjpegServer::serveClient(Client* client) {
+    const socket_t s = (socket_t)client->socket;
+
+    // only the request line matters
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        int n = (int)recv(s, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, (size_t)n);
+    }
+    std::string path;
+    std::istringstream line(request);
+    std::string method;
+    line >> method >> path;
+
+    if (method != "GET") {
+        sendAll(s, "HTTP/1.0 405 Method Not Allowed\r\nConnection: close\r\n\r\n");
+    } else if (path == "/" || path == "/stream") {
+        streamTo(client);
+    } else if (path == "/stats") {
+        std::string body = statsJson();
+        sendAll(s, "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+    } else if (path == "/snapshot.jpg") {
+        std::shared_ptr<const Jpeg> jpeg;
+        {
+            // the encoders only run while someone is connected, which we now are
+            std::unique_lock<std::mutex> lock(m_mutex);
+            ++m_clientCount;
+            m_frameReady.wait_for(lock, std::chrono::seconds(2), [this] { return m_stopping || m_latest; });
+            --m_clientCount;
+            jpeg = m_latest;
+        }
+        if (!jpeg) {
+            sendAll(s, "HTTP/1.0 503 Service Unavailable\r\nConnection: close\r\n\r\n");
+        } else if (sendAll(s, "HTTP/1.0 200 OK\r\nContent-Type: image/jpeg\r\nContent-Length: " +
+                              std::to_string(jpeg->data.size()) + "\r\nConnection: close\r\n\r\n")) {
+            sendAll(s, (const char*)jpeg->data.data(), jpeg->data.size());
+        }
+    } else {
+        sendAll(s, "HTTP/1.0 404 Not Found\r\nConnection: close\r\n\r\n");
+    }
+
+    // under the lock, so stop() never shuts down a descriptor that was already reused
+    std::lock_guard<std::mutex> lock(m_mutex);
+    closeSocket(s);
+    client->finished = true;
+}
+
+void MjpegServer::streamTo(Client* client) {
+    const socket_t s = (socket_t)client->socket;
+    if (!sendAll(s, "HTTP/1.0 200 OK\r\nContent-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+                    "Cache-Control: no-cache\r\nConnection: close\r\n\r\n")) return;
+
+    ++m_clientCount;
+    std::cout << "[HTTP] Client " << client->stats.address << " connected\n";
+    uint64_t lastIndex = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    client->streaming = true;
+    client->windowStart = std::chrono::steady_clock::now();
+    while (true) {
+        m_frameReady.wait(lock, [&] { return m_stopping || (m_latest && m_latest->index != lastIndex); });
+        if (m_stopping) break;
+        // hold a reference, the encoders may publish newer frames while this one is sent
+        std::shared_ptr<const Jpeg> jpeg = m_latest;
+        if (lastIndex != 0 && jpeg->index > lastIndex + 1) client->stats.dropped += jpeg->index - lastIndex - 1;
+        lastIndex = jpeg->index;
+        lock.unlock();
+
+        bool ok = sendAll(s, "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " +
+                             std::to_string(jpeg->data.size()) + "\r\n\r\n") &&
+                  sendAll(s, (const char*)jpeg->data.data(), jpeg->data.size()) &&
+                  sendAll(s, "\r\n");
+
+        lock.lock();
+        if (!ok) break;
+        ++client->stats.sent;
+        ++client->windowSent;
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - client->windowStart).count();
+        if (elapsed >= 1.0) {
+            client->stats.fps = client->windowSent / elapsed;
+            client->windowSent = 0;
+            client->windowStart = now;
+        }
+    }
+    lock.unlock();
+    --m_clientCount;
+    std::cout << "[HTTP] Client " << client->stats.address << " disconnected after "
+              << client->stats.sent << " frames (" << client->stats.dropped << " dropped)\n";
+}
+
+void MjpegServer::reapClients(bool all) {
+    std::vector<std::unique_ptr<Client>> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_clients.size();) {
+            if (all || m_clients[i]->finished) {
+                done.push_back(std::move(m_clients[i]));
+                m_clients.erase(m_clients.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+    }
+    for (auto& c : done) c->thread.join();
+}
+
+MjpegStats MjpegServer::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MjpegStats s;
+    s.encoded = m_encoded;
+    s.skipped = m_skipped;
+    s.avgEncodeMs = m_encoded ? m_encodeMs / m_encoded : 0.0;
+    s.queueDepth = (int)m_jobs.size() + m_encoding;
+    s.maxInFlight = (int)m_maxInFlight;
+    for (const auto& c : m_clients)
+        if (c->streaming && !c->finished) s.clients.push_back(c->stats);
+    return s;
+}
+
+std::string MjpegServer::statsJson() const {
+    MjpegStats s = stats();
+    std::ostringstream json;
+    json << "{\"encoded\":" << s.encoded << ",\"skipped\":" << s.skipped
+         << ",\"avg_encode_ms\":" << s.avgEncodeMs << ",\"queue_depth\":" << s.queueDepth
+         << ",\"max_in_flight\":" << s.maxInFlight << ",\"clients\":[";
+    for (size_t i = 0; i < s.clients.size(); ++i) {
+        const MjpegClientStats& c = s.clients[i];
+        json << (i ? "," : "") << "{\"address\":\"" << c.address << "\",\"sent\":" << c.sent
+             << ",\"dropped\":" << c.dropped << ",\"fps\":" << c.fps << "}";
+    }
+    json << "]}\n";
+    return json.str();
+}
@@ -0,0 +1,133 @@
+/*
+ * MjpegServer.hpp
+ *
+ *  Minimal HTTP server that streams the processed output as MJPEG
+ *  (multipart/x-mixed-replace) to browsers and players on the network.
+ *
+ */
+#ifndef MJPEGSERVER_HPP
+#define MJPEGSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+//! MjpegClientStats
+struct MjpegClientStats {
+    std::string address;
+    uint64_t sent = 0;
+    uint64_t dropped = 0;       //!< encoded frames the client was too slow to receive
+    double fps = 0.0;           //!< over the last second
+};
+
+//! MjpegStats
+struct MjpegStats {
+    uint64_t encoded = 0;
+    uint64_t skipped = 0;       //!< submitted while every encoder slot was busy
+    double avgEncodeMs = 0.0;
+    int queueDepth = 0;         //!< frames queued or being encoded right now
+    int maxInFlight = 0;
+    std::vector<MjpegClientStats> clients;
+};
+
+//!  MjpegServer.
+/*!
+ GET /stream (or /) serves an endless multipart/x-mixed-replace stream, /snapshot.jpg the newest
+ frame and /stats the counters as JSON. submit() copies a frame to a pool of JPEG encoder
+ threads and returns immediately; it does nothing while no client is connected. Each client has
+ its own sender thread that always sends the newest JPEG, so a slow viewer skips frames instead
+ of building a queue, and never holds up the render loop or the other viewers.
+ */
+class MjpegServer {
+public:
+    MjpegServer();
+    //! Destructor
+    /*! Calls stop(). */
+    ~MjpegServer();
+
+    //! start
+    /*! Listens on the given port on all interfaces. */
+    bool start(int port, int encodeThreads = 2, int quality = 80);
+    //! stop
+    /*! Disconnects every client and joins all threads. */
+    void stop();
+    bool isRunning() const { return m_running; }
+    int port() const { return m_port; }
+
+    //! wantsFrames
+    /*! True while at least one client is connected. */
+    bool wantsFrames() const { return m_clientCount.load() > 0; }
+    //! submit
+    /*! Queues a BGR frame for encoding; bottomUp frames (GL readback) are flipped by the encoder.
+        False if it was skipped because nobody is watching or all encoder slots are busy. */
+    bool submit(const cv::Mat& frame, int64_t captureTimeNs, bool bottomUp);
+
+    MjpegStats stats() const;
+
+private:
+    struct Job {
+        cv::Mat frame;
+        uint64_t sequence;
+        bool bottomUp;
+    };
+    struct Jpeg {
+        std::vector<uchar> data;
+        uint64_t index;         //!< counts published JPEGs, for per-client drop counting
+    };
+    struct Client {
+        intptr_t socket;
+        std::thread thread;
+        MjpegClientStats stats;
+        uint64_t windowSent = 0;
+        std::chrono::steady_clock::time_point windowStart;
+        bool streaming = false;     //!< on /stream, as opposed to a one-off request
+        bool finished = false;
+    };
+
+    void acceptLoop();
+    void encodeLoop();
+    void serveClient(Client* client);
+    //! streamTo
+    /*! Sends the newest JPEG whenever there is a new one, until the client goes away. */
+    void streamTo(Client* client);
+    //! reapClients
+    /*! Joins the threads of clients that disconnected. */
+    void reapClients(bool all);
+    std::string statsJson() const;
+
+    int m_port;
+    int m_quality;
+    size_t m_maxInFlight;
+    bool m_running;
+    bool m_stopping;
+    intptr_t m_listenSocket;
+
+    std::thread m_acceptThread;
+    std::vector<std::thread> m_encoders;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    std::atomic<int> m_clientCount;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_frameReady;
+    std::deque<Job> m_jobs;
+    std::vector<cv::Mat> m_spare;
+    int m_encoding;                     //!< jobs taken by an encoder thread
+    uint64_t m_submitted;
+    uint64_t m_latestSequence;          //!< submit sequence of m_latest, older results are discarded
+    std::shared_ptr<const Jpeg> m_latest;
+    uint64_t m_encoded;
+    uint64_t m_skipped;
+    double m_encodeMs;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * SharedFrameProtocol.hpp
+ *
+ *  Memory layout of the shared-memory frame ring written by SharedFrameWriter
+ *  and read by SharedFrameReader. Plain C++, no OpenCV, so other programs can
+ *  include it directly.
+ *
+ */
+#ifndef SHAREDFRAMEPROTOCOL_HPP
+#define SHAREDFRAMEPROTOCOL_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Layout
+//   [ShmRingHeader, one page] [slot 0] [slot 1] ... [slot N-1]
+//   slot = [ShmSlotHeader, 64 bytes] [pixels, padded to a page]
+//
+// Each slot is guarded by a seqlock: the writer sets its state to an odd value while it writes
+// and to an even value when done, so a reader can tell whether the pixels it looked at were
+// overwritten in the meantime. The writer never waits for readers; a reader that is too slow
+// sees its frames overwritten and skips ahead. Readers publish their position in a cursor table
+// so the writer can report how far behind each one is.
+
+static const char kShmMagic[8] = { 'V', 'C', 'S', 'H', 'M', 'R', 'N', 'G' };
+static const uint32_t kShmVersion = 1;
+static const uint32_t kShmPageSize = 4096;
+static const uint32_t kShmMaxReaders = 16;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock free");
+
+//! ShmPixelFormat
+/*! Same values as RawPixelFormat. */
+enum ShmPixelFormat : uint32_t {
+    SHM_FORMAT_BGR24 = 1,
+    SHM_FORMAT_GRAY8 = 2
+};
+
+//! ShmReaderCursor
+/*! One registered reader. pid 0 marks a free entry. */
+struct ShmReaderCursor {
+    std::atomic<uint64_t> pid;              //!< owner process, claimed with compare-exchange
+    std::atomic<uint64_t> lastSequence;     //!< last frame the reader took
+    std::atomic<uint64_t> dropped;          //!< frames the reader never saw
+    std::atomic<int64_t> heartbeatNs;       //!< CLOCK_MONOTONIC time of the last read
+};
+
+//! ShmRingHeader
+/*! First page of the segment. */
+struct ShmRingHeader {
+    char magic[8];                          //!< written last, once the layout is valid
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t slotCount;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                        //!< bytes per row
+    uint32_t pixelFormat;                   //!< ShmPixelFormat
+    uint32_t writerPid;                     //!< process that created the segment
+    uint64_t slotBytes;                     //!< distance between slots, page aligned
+    uint64_t firstSlotOffset;
+    std::atomic<uint64_t> writeSequence;    //!< sequence of the newest complete frame, 0 = none yet
+    std::atomic<uint32_t> retired;          //!< set when the writer closes or changes the layout
+    std::atomic<uint32_t> readerCount;
+    ShmReaderCursor readers[kShmMaxReaders];
+};
+
+//! ShmSlotHeader
+/*! Metadata in front of each frame. */
+struct ShmSlotHeader {
+    std::atomic<uint64_t> state;            //!< seqlock: 2 * sequence + 1 while writing, 2 * sequence when done
+    int64_t captureTimeNs;                  //!< steady clock of the capturing process
+    int64_t publishTimeNs;                  //!< CLOCK_MONOTONIC when the frame was completed
+    uint64_t reserved[5];
+};
+
+static_assert(sizeof(ShmRingHeader) <= kShmPageSize, "ring header must fit in one page");
+static_assert(sizeof(ShmSlotHeader) == 64, "slot header is one cache line");
+
+//! shmSlotIndex
+/*! Slot that holds frame number sequence (sequences start at 1). */
+inline uint32_t shmSlotIndex(uint64_t sequence, uint32_t slotCount) {
+    return (uint32_t)((sequence - 1) % slotCount);
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "SharedFrameReader.hpp"
+
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int64_t monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SharedFrameReader::SharedFrameReader()
+    : m_base(nullptr), m_size(0), m_header(nullptr), m_cursor(nullptr), m_lastSequence(0), m_dropped(0) {}
+
+SharedFrameReader::~SharedFrameReader() {
+    close();
+}
+
+bool SharedFrameReader::open(const std::string& name) {
+    close();
+    m_name = name;
+    m_lastSequence = 0;
+    m_dropped = 0;
+    return map();
+}
+
+void SharedFrameReader::close() {
+    unmap();
+    m_name.clear();
+}
+
+bool SharedFrameReader::writerRetired() const {
+    return !m_header || m_header->retired.load(std::memory_order_acquire) != 0;
+}
+
+#ifndef _WIN32
+
+bool SharedFrameReader::map() {
+    int fd = shm_open(m_name.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < kShmPageSize) {
+        ::close(fd);
+        return false;
+    }
+    // the header page is writable for the cursor table, the frames are mapped read-only
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    void* header = mmap(base, kShmPageSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    ::close(fd);
+    if (header == MAP_FAILED) {
+        munmap(base, (size_t)st.st_size);
+        return false;
+    }
+
+    ShmRingHeader* h = (ShmRingHeader*)base;
+    if (memcmp(h->magic, kShmMagic, sizeof(kShmMagic)) != 0 || h->version != kShmVersion ||
+        h->firstSlotOffset + h->slotBytes * h->slotCount > (uint64_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    m_base = (unsigned char*)base;
+    m_size = (size_t)st.st_size;
+    m_header = h;
+
+    // claim a cursor; entries of processes that are gone are reclaimed
+    uint64_t self = (uint64_t)getpid();
+    for (uint32_t i = 0; i < kShmMaxReaders && !m_cursor; ++i) {
+        ShmReaderCursor& c = m_header->readers[i];
+        uint64_t owner = c.pid.load(std::memory_order_acquire);
+        bool stale = owner != 0 && kill((pid_t)owner, 0) != 0 && errno == ESRCH;
+        if ((owner == 0 || stale) && c.pid.compare_exchange_strong(owner, self)) {
+            c.lastSequence.store(m_lastSequence, std::memory_order_relaxed);
+            c.dropped.store(m_dropped, std::memory_order_relaxed);
+            c.heartbeatNs.store(monotonicNowNs(), std::memory_order_relaxed);
+            m_header->readerCount.fetch_add(1);
+            m_cursor = &c;
+        }
+    }
+    return true;    // without a free cursor the reader still works, it is just not reported
+}
+
+void SharedFrameReader::unmap() {
+    if (!m_base) return;
+    if (m_cursor) {
+        m_cursor->pid.store(0, std::memory_order_release);
+        m_header->readerCount.fetch_sub(1);
+    }
+    munmap(m_base, m_size);
+    m_base = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_cursor = nullptr;
+}
+
+#else
+
+bool SharedFrameReader::map() { return false; }
+void SharedFrameReader::unmap() {}
+
+#endif
+
+bool SharedFrameReader::latest(SharedFrameView& view) {
+    if (writerRetired()) {
+        // the writer closed or resized the ring; pick up its replacement if there is one
+        unmap();
+        if (m_name.empty() || !map()) return false;
+        m_lastSequence = 0;
+    }
+
+    uint64_t sequence = m_header->writeSequence.load(std::memory_order_acquire);
+    if (sequence == 0 || sequence == m_lastSequence) return false;
+
+    const unsigned char* slot = m_base + m_header->firstSlotOffset +
+                                m_header->slotBytes * shmSlotIndex(sequence, m_header->slotCount);
+    const ShmSlotHeader* slotHeader = (const ShmSlotHeader*)slot;
+    if (slotHeader->state.load(std::memory_order_acquire) != 2 * sequence) {
+        return false;   // already being overwritten, the next call sees a newer frame
+    }
+
+    view.data = slot + sizeof(ShmSlotHeader);
+    view.width = (int)m_header->width;
+    view.height = (int)m_header->height;
+    view.stride = (int)m_header->stride;
+    view.pixelFormat = m_header->pixelFormat;
+    view.sequence = sequence;
+    view.captureTimeNs = slotHeader->captureTimeNs;
+    view.publishTimeNs = slotHeader->publishTimeNs;
+    view.slot = slotHeader;
+
+    if (m_lastSequence != 0 && sequence > m_lastSequence + 1) m_dropped += sequence - m_lastSequence - 1;
+    m_lastSequence = sequence;
+    if (m_cursor) {
+        m_cursor->lastSequence.store(sequence, std::memory_order_relaxed);
+        m_cursor->dropped.store(m_dropped, std::memory_order_relaxed);
+        m_cursor->heartbeatNs.store(monotonicNowNs(), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool SharedFrameReader::isValid(const SharedFrameView& view) const {
+    if (!view.slot) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot->state.load(std::memory_order_relaxed) == 2 * view.sequence;
+}
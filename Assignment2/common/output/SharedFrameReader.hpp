@@ -0,0 +1,75 @@
+/*
+ * SharedFrameReader.hpp
+ *
+ *  Reader side of the shared-memory frame ring. No OpenCV dependency: frames are
+ *  returned as pointers into the mapping.
+ *
+ */
+#ifndef SHAREDFRAMEREADER_HPP
+#define SHAREDFRAMEREADER_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "SharedFrameProtocol.hpp"
+
+//! SharedFrameView
+/*! A frame inside the mapping. Valid until the writer wraps around to its slot; check with
+    SharedFrameReader::isValid() after using the pixels. */
+struct SharedFrameView {
+    const unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    uint32_t pixelFormat = 0;       //!< ShmPixelFormat
+    uint64_t sequence = 0;
+    int64_t captureTimeNs = 0;
+    int64_t publishTimeNs = 0;
+    const ShmSlotHeader* slot = nullptr;
+};
+
+//!  SharedFrameReader.
+/*!
+ Maps the ring read-only (plus the cursor table) and hands out the newest frame without copying.
+ Registers a cursor so the writer can see how far behind the reader is. If the writer replaces
+ the segment (size change, restart), latest() reopens it transparently.
+ */
+class SharedFrameReader {
+public:
+    SharedFrameReader();
+    ~SharedFrameReader();
+
+    //! open
+    /*! Maps the segment created by a SharedFrameWriter and registers a reader cursor. */
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    //! latest
+    /*! Newest complete frame if it is newer than the last one returned. Never blocks. */
+    bool latest(SharedFrameView& view);
+    //! isValid
+    /*! True if the writer has not touched the frame's slot since latest() returned it. */
+    bool isValid(const SharedFrameView& view) const;
+
+    //! dropped
+    /*! Frames published but never returned by latest(), either skipped or overwritten. */
+    uint64_t dropped() const { return m_dropped; }
+    //! writerRetired
+    /*! True if the writer closed the segment. */
+    bool writerRetired() const;
+
+private:
+    bool map();
+    void unmap();
+
+    std::string m_name;
+    unsigned char* m_base;
+    size_t m_size;
+    ShmRingHeader* m_header;
+    ShmReaderCursor* m_cursor;
+    uint64_t m_lastSequence;
+    uint64_t m_dropped;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include "SharedFrameWriter.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static size_t alignToPage(size_t bytes) {
+    return (bytes + kShmPageSize - 1) / kShmPageSize * kShmPageSize;
+}
+
+#ifndef _WIN32
+//! segmentIsStale
+/*! True if the segment called name was left behind: retired, or its writer process is gone. A
+    segment that is not ours, or is still being set up, counts as in use. */
+static bool segmentIsStale(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return errno == ENOENT;
+    struct stat st;
+    bool stale = false;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= kShmPageSize) {
+        void* base = mmap(nullptr, kShmPageSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (base != MAP_FAILED) {
+            const ShmRingHeader* h = (const ShmRingHeader*)base;
+            if (memcmp(h->magic, kShmMagic, sizeof(kShmMagic)) == 0) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                stale = h->retired.load(std::memory_order_acquire) != 0 ||
+                        (h->writerPid != 0 && kill((pid_t)h->writerPid, 0) != 0 && errno == ESRCH);
+            }
+            munmap(base, kShmPageSize);
+        }
+    }
+    ::close(fd);
+    return stale;
+}
+#endif
+
+static int64_t monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SharedFrameWriter::SharedFrameWriter()
+    : m_slotCount(8), m_base(nullptr), m_size(0), m_header(nullptr), m_sequence(0), m_pending(nullptr) {}
+
+SharedFrameWriter::~SharedFrameWriter() {
+    close();
+}
+
+bool SharedFrameWriter::open(const std::string& name, uint32_t slotCount) {
+#ifdef _WIN32
+    std::cerr << "[SHM] Shared-memory output needs POSIX shared memory\n";
+    return false;
+#else
+    close();
+    if (name.empty() || name[0] != '/' || slotCount < 2) return false;
+    m_name = name;
+    m_slotCount = slotCount;
+    return true;
+#endif
+}
+
+void SharedFrameWriter::close() {
+    destroySegment();
+    m_name.clear();
+}
+
+bool SharedFrameWriter::createSegment(int width, int height, int type) {
+#ifdef _WIN32
+    return false;
+#else
+    destroySegment();
+
+    const uint32_t stride = (uint32_t)(width * CV_ELEM_SIZE(type));
+    const size_t slotBytes = alignToPage(sizeof(ShmSlotHeader) + (size_t)stride * height);
+    const size_t size = kShmPageSize + slotBytes * m_slotCount;
+
+    int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0 && errno == EEXIST) {
+        // only a segment left behind by a crashed writer is taken over, never a live one
+        if (!segmentIsStale(m_name)) {
+            std::cerr << "[SHM] " << m_name << " is in use by another process\n";
+            return false;
+        }
+        shm_unlink(m_name.c_str());
+        fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    }
+    if (fd < 0) {
+        std::cerr << "[SHM] shm_open(" << m_name << ") failed: " << strerror(errno) << "\n";
+        return false;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        std::cerr << "[SHM] Cannot size " << m_name << " to " << size << " bytes\n";
+        ::close(fd);
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, so every atomic starts at 0
+    m_base = (unsigned char*)base;
+    m_size = size;
+    m_header = (ShmRingHeader*)m_base;
+    m_header->version = kShmVersion;
+    m_header->headerSize = sizeof(ShmRingHeader);
+    m_header->slotCount = m_slotCount;
+    m_header->width = (uint32_t)width;
+    m_header->height = (uint32_t)height;
+    m_header->stride = stride;
+    m_header->pixelFormat = CV_MAT_CN(type) == 3 ? SHM_FORMAT_BGR24 : SHM_FORMAT_GRAY8;
+    m_header->slotBytes = slotBytes;
+    m_header->firstSlotOffset = kShmPageSize;
+    m_header->writerPid = (uint32_t)getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(m_header->magic, kShmMagic, sizeof(kShmMagic));
+    m_sequence = 0;
+
+    std::cout << "[SHM] Publishing " << width << "x" << height << " frames to " << m_name
+              << " (" << m_slotCount << " slots, " << size / (1024 * 1024) << " MB)\n";
+    return true;
+#endif
+}
+
+void SharedFrameWriter::destroySegment() {
+#ifndef _WIN32
+    if (!m_base) return;
+    // readers still mapping the old segment see this and reopen
+    m_header->retired.store(1, std::memory_order_release);
+    munmap(m_base, m_size);
+    shm_unlink(m_name.c_str());
+    m_base = nullptr;
+    m_header = nullptr;
+    m_size = 0;
+    m_pending = nullptr;
+#endif
+}
+
+cv::Mat SharedFrameWriter::beginFrame(int width, int height, int type) {
+    if (!isOpen() || (type != CV_8UC3 && type != CV_8UC1)) return cv::Mat();
+
+    int channels = type == CV_8UC3 ? 3 : 1;
+    uint32_t format = channels == 3 ? SHM_FORMAT_BGR24 : SHM_FORMAT_GRAY8;
+    if (!m_header || (int)m_header->width != width || (int)m_header->height != height ||
+        m_header->pixelFormat != format) {
+        if (!createSegment(width, height, type)) return cv::Mat();
+    }
+
+    uint64_t sequence = m_sequence + 1;
+    unsigned char* slot = m_base + m_header->firstSlotOffset + m_header->slotBytes * shmSlotIndex(sequence, m_slotCount);
+    m_pending = (ShmSlotHeader*)slot;
+    // odd state: readers holding a view of the previous frame in this slot now see it as invalid
+    m_pending->state.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return cv::Mat(height, width, type, slot + sizeof(ShmSlotHeader), m_header->stride);
+}
+
+void SharedFrameWriter::commitFrame(int64_t captureTimeNs) {
+    if (!m_pending) return;
+    uint64_t sequence = m_sequence + 1;
+    m_pending->captureTimeNs = captureTimeNs;
+    m_pending->publishTimeNs = monotonicNowNs();
+    m_pending->state.store(2 * sequence, std::memory_order_release);
+    m_header->writeSequence.store(sequence, std::memory_order_release);
+    m_sequence = sequence;
+    m_pending = nullptr;
+}
+
+bool SharedFrameWriter::publish(const cv::Mat& frame, int64_t captureTimeNs) {
+    cv::Mat slot = beginFrame(frame.cols, frame.rows, frame.type());
+    if (slot.empty()) return false;
+    frame.copyTo(slot);
+    commitFrame(captureTimeNs);
+    return true;
+}
+
+int SharedFrameWriter::readerLag(SharedReaderLag* lag, int maxReaders) const {
+    if (!m_header) return 0;
+    int n = 0;
+    for (uint32_t i = 0; i < kShmMaxReaders; ++i) {
+        const ShmReaderCursor& c = m_header->readers[i];
+        uint64_t pid = c.pid.load(std::memory_order_acquire);
+        if (pid == 0) continue;
+        if (n < maxReaders) {
+            uint64_t last = c.lastSequence.load(std::memory_order_relaxed);
+            lag[n].pid = pid;
+            lag[n].behind = m_sequence > last ? m_sequence - last : 0;
+            lag[n].dropped = c.dropped.load(std::memory_order_relaxed);
+        }
+        ++n;
+    }
+    return n;
+}
@@ -0,0 +1,76 @@
+/*
+ * SharedFrameWriter.hpp
+ *
+ *  Publishes processed frames into a POSIX shared-memory ring for other local processes.
+ *
+ */
+#ifndef SHAREDFRAMEWRITER_HPP
+#define SHAREDFRAMEWRITER_HPP
+
+#include <cstdint>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "SharedFrameProtocol.hpp"
+
+//! SharedReaderLag
+/*! What the writer knows about one registered reader. */
+struct SharedReaderLag {
+    uint64_t pid;
+    uint64_t behind;        //!< frames between the newest one and the reader's last
+    uint64_t dropped;       //!< frames the reader reported as missed
+};
+
+//!  SharedFrameWriter.
+/*!
+ Owns the segment (shm_open + mmap) and writes frames round-robin into its slots. beginFrame()
+ returns a cv::Mat that points straight into the next slot, so the last processing step can write
+ its output there without an extra copy; commitFrame() publishes it. Never waits for readers.
+ When the frame size changes, the old segment is retired and a new one is created under the
+ same name. POSIX only; open() fails on Windows.
+ */
+class SharedFrameWriter {
+public:
+    SharedFrameWriter();
+    //! Destructor
+    /*! Retires and unlinks the segment. */
+    ~SharedFrameWriter();
+
+    //! open
+    /*! Remembers the name (e.g. "/vc_frames"). The segment is created by the first frame. */
+    bool open(const std::string& name, uint32_t slotCount = 8);
+    void close();
+    bool isOpen() const { return !m_name.empty(); }
+
+    //! beginFrame
+    /*! View of the next slot for a CV_8UC3 or CV_8UC1 frame of the given size. Empty on failure. */
+    cv::Mat beginFrame(int width, int height, int type);
+    //! commitFrame
+    /*! Publishes the slot returned by beginFrame(). */
+    void commitFrame(int64_t captureTimeNs);
+    //! publish
+    /*! Copies frame into the next slot and publishes it. */
+    bool publish(const cv::Mat& frame, int64_t captureTimeNs);
+
+    uint64_t published() const { return m_sequence; }
+    //! readerLag
+    /*! Fills up to maxReaders entries, returns how many readers are registered. */
+    int readerLag(SharedReaderLag* lag, int maxReaders) const;
+
+private:
+    //! createSegment
+    /*! Retires the current segment and creates one for the given layout. */
+    bool createSegment(int width, int height, int type);
+    void destroySegment();
+
+    std::string m_name;
+    uint32_t m_slotCount;
+    unsigned char* m_base;
+    size_t m_size;
+    ShmRingHeader* m_header;
+    uint64_t m_sequence;            //!< last published frame
+    ShmSlotHeader* m_pending;       //!< slot handed out by beginFrame()
+};
+
+#endif
@@ -4,8 +4,9 @@ out vec3 color;
 
 uniform sampler2D myTextureSampler;
 uniform float pixelSize = 0.02; // adjust for pixelation strength
+// yuvFormat, flipRows and sampleVideo() come from videoSample.glsl
 
 void main() {
     vec2 uv = floor(UV / pixelSize) * pixelSize;
-    color = texture(myTextureSampler, uv).rgb;
+    color = sampleVideo(myTextureSampler, uv);
 }
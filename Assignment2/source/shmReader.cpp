@@ -0,0 +1,84 @@
+// Example consumer of the shared-memory output (Assignment2 --shm <name>).
+// Maps the ring, follows the newest frame and reports sequence, age and drops once per second.
+// With --snapshot <file> the first frame received is also written as an image.
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include <common/output/SharedFrameReader.hpp>
+
+using namespace std;
+
+int64_t steadyNowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv) {
+    string name = "/vc_frames";
+    string snapshot;
+    int seconds = 0;    // 0 = until killed
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--snapshot" && hasValue) snapshot = argv[++i];
+        else if (arg == "--seconds" && hasValue) seconds = atoi(argv[++i]);
+        else if (arg[0] != '-') name = arg[0] == '/' ? arg : "/" + arg;
+        else {
+            cout << "Usage: " << argv[0] << " [name] [--snapshot <image>] [--seconds <n>]\n";
+            return -1;
+        }
+    }
+
+    SharedFrameReader reader;
+    if (!reader.open(name)) cout << "[SHM] Waiting for " << name << "...\n";
+
+    auto start = chrono::steady_clock::now();
+    auto intervalStart = start;
+    int frames = 0, torn = 0;
+    double ageMsSum = 0.0;
+    uint64_t lastSequence = 0;
+    while (seconds == 0 || chrono::steady_clock::now() - start < chrono::seconds(seconds)) {
+        SharedFrameView view;
+        if (!reader.latest(view)) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        } else {
+            // the pixels are used in place; a real consumer would process them here
+            cv::Mat frame(view.height, view.width, view.pixelFormat == SHM_FORMAT_BGR24 ? CV_8UC3 : CV_8UC1,
+                          (void*)view.data, (size_t)view.stride);
+            if (!snapshot.empty()) {
+                cv::Mat copy = frame.clone();
+                if (reader.isValid(view)) {
+                    cv::imwrite(snapshot, copy);
+                    cout << "[SHM] Wrote frame " << view.sequence << " to " << snapshot << "\n";
+                    snapshot.clear();
+                }
+            }
+            if (reader.isValid(view)) {
+                ageMsSum += (steadyNowNs() - view.captureTimeNs) / 1e6;
+                ++frames;
+            } else {
+                ++torn;     // overwritten while in use: we were more than a ring behind
+            }
+            lastSequence = view.sequence;
+        }
+
+        auto now = chrono::steady_clock::now();
+        double elapsed = chrono::duration<double>(now - intervalStart).count();
+        if (elapsed >= 1.0) {
+            cout << "[SHM] Sequence: " << lastSequence
+                 << " | FPS: " << fixed << setprecision(2) << frames / elapsed
+                 << " | Age: " << (frames ? ageMsSum / frames : 0.0) << " ms"
+                 << " | Dropped: " << reader.dropped()
+                 << " | Overwritten: " << torn << "\n";
+            frames = 0;
+            torn = 0;
+            ageMsSum = 0.0;
+            intervalStart = now;
+        }
+    }
+    return 0;
+}
@@ -3,9 +3,10 @@ in vec2 UV;
 out vec4 color;
 uniform sampler2D videoTexture;
 uniform mat4 MVP;
+// yuvFormat, flipRows and sampleVideo() come from videoSample.glsl
 
 void main() {
-    vec4 texColor = texture(videoTexture, UV);
+    vec4 texColor = vec4(sampleVideo(videoTexture, UV), 1.0);
     float gray = dot(texColor.rgb, vec3(0.299, 0.587, 0.114));
     vec3 result = vec3(gray);
     if (texColor.r > 0.6 && texColor.r > texColor.g * 1.3 && texColor.r > texColor.b * 1.3)
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec2 tilePosition;    // unit square, (0,0) = bottom left corner of the tile
+
+out vec2 UV;
+
+uniform mat4 MVP;
+uniform vec4 tileRect;     // model space: x0, y0 (bottom left), x1, y1 (top right)
+uniform vec4 frameRect;    // frame texture coordinates the tile covers, top-down: u0, v0, u1, v1
+
+void main() {
+    gl_Position = MVP * vec4(mix(tileRect.xy, tileRect.zw, tilePosition), 0.0, 1.0);
+    // UV spans the whole frame as on an untiled quad; sampleVideo() flips the top-down rows
+    // (flipRows) and maps the result into this tile's texture (frameToTile)
+    UV = vec2(mix(frameRect.x, frameRect.z, tilePosition.x), 1.0 - mix(frameRect.w, frameRect.y, tilePosition.y));
+}
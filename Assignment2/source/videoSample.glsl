@@ -0,0 +1,36 @@
+// Video sampling shared by the video fragment shaders. Shader splices this file in right after
+// their #version line (see TextureShader and TileShader), so it is kept in one place.
+
+uniform int yuvFormat = 0;          // 0 = BGR texture, 1 = YUYV, 2 = NV12 (see Texture::Format)
+uniform sampler2D chromaSampler;    // NV12 UV plane, texture unit 1
+uniform bool flipRows = false;      // rows were uploaded top-down (YUV, persistent BGR uploads)
+// tiled frames (TileShader): UV covers the whole frame, these map it into the bound tile's texture
+uniform vec4 frameToTile = vec4(1.0, 1.0, 0.0, 0.0);   // scale (xy), offset (zw)
+uniform vec4 tileClamp = vec4(0.0, 0.0, 1.0, 1.0);     // outermost texel centres of the tile
+
+// BT.601 limited range, as delivered by webcams
+vec3 yuvToRgb(float y, float u, float v) {
+    y = 1.1644 * (y - 0.0627);
+    u -= 0.5;
+    v -= 0.5;
+    return clamp(vec3(y + 1.5960 * v, y - 0.3918 * u - 0.8130 * v, y + 2.0172 * u), 0.0, 1.0);
+}
+
+vec3 sampleVideo(sampler2D tex, vec2 uv) {
+    // top-down uploads are flipped here instead of on the CPU
+    if (flipRows) uv.y = 1.0 - uv.y;
+    uv = clamp(uv * frameToTile.xy + frameToTile.zw, tileClamp.xy, tileClamp.zw);
+    if (yuvFormat == 0) return texture(tex, uv).rgb;
+    float y = texture(tex, uv).r;
+    if (yuvFormat == 2) {
+        vec2 c = texture(chromaSampler, uv).rg;
+        return yuvToRgb(y, c.r, c.g);
+    }
+    // YUYV: every texel has its Y in .r, U and V alternate in .g
+    ivec2 size = textureSize(tex, 0);
+    ivec2 p = clamp(ivec2(uv * vec2(size)), ivec2(0), size - 1);
+    p.x -= p.x % 2;
+    float u = texelFetch(tex, p, 0).g;
+    float v = texelFetch(tex, p + ivec2(1, 0), 0).g;
+    return yuvToRgb(y, u, v);
+}
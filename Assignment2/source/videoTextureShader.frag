@@ -3,8 +3,9 @@ in vec2 UV;
 out vec4 FragColor;
 
 uniform sampler2D texture1;
+// yuvFormat, flipRows and sampleVideo() come from videoSample.glsl
 
 void main() {
-    FragColor = texture(texture1, UV);
+    FragColor = vec4(sampleVideo(texture1, UV), 1.0);
    
 }
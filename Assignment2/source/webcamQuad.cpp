@@ -3,8 +3,15 @@
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <deque>
 #include <iomanip>
+#include <sstream>
 #include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <future>
+#include <functional>
 
 #include <opencv2/opencv.hpp>
 #include <glad/gl.h>
@@ -18,9 +25,25 @@
 #include <common/TextureShader.hpp>
 #include <common/Quad.hpp>
 #include <common/Texture.hpp>
+#include <common/TiledTexture.hpp>
+#include <common/TileShader.hpp>
+#include <common/TextureCache.hpp>
+#include <common/FramePool.hpp>
+#include <common/WorkStealingPool.hpp>
 #include <common/Scene.hpp>
 #include <common/Camera.hpp>
+#include <common/RenderTarget.hpp>
 #include <common/filters/CPUFilters.hpp>
+#include <common/capture/CaptureThread.hpp>
+#include <common/capture/FrameSource.hpp>
+#include <common/capture/SyntheticSource.hpp>
+#include <common/capture/RawFrameFile.hpp>
+#include <common/capture/LatestFrameWorker.hpp>
+#include <common/output/SharedFrameWriter.hpp>
+#include <common/output/FrameReadback.hpp>
+#include <common/output/FrameEncoder.hpp>
+#include <common/output/MjpegServer.hpp>
+#include <common/compression/BC1Encoder.hpp>
 
 using namespace std;
 
@@ -35,32 +58,175 @@ bool mousePressed = false;
 double lastX = 0.0, lastY = 0.0;
 
 enum FilterType { FILTER_NONE, FILTER_PIXELATE, FILTER_SINCITY };
-FilterType activeFilter = FILTER_NONE;
+std::atomic<FilterType> activeFilter(FILTER_NONE);   // also read by the CPU processing worker
 bool useGPU = true;
 
 std::atomic<bool> batchRequested(false);
 std::atomic<bool> batchRunning(false);
 
-
-bool warmupCamera(cv::VideoCapture &cap, const int maxAttempts = 80, int msBetween = 15) {
-    cv::Mat tmp;
-    for (int i = 0; i < maxAttempts; ++i) {
-        cap >> tmp;
-        if (!tmp.empty()) return true;
-        std::this_thread::sleep_for(std::chrono::milliseconds(msBetween));
-    }
-    return false;
+// Command line options
+struct AppOptions {
+    FrameSourceConfig source;
+    string recordPath;          // raw recording of every captured frame
+    bool batchOnly = false;     // run the experiments right away and exit
+    int batchSeconds = 8;       // length of each experiment run
+    int decodeThreads = 2;      // MJPG decode workers, 0 = decode on the capture thread
+    bool asyncProcessing = true;    // CPU filters on a latest-frame-wins worker, display at its own rate
+    string shmName;             // publish displayed frames into this POSIX shared-memory ring
+    int shmSlots = 8;
+    string recordOutputPath;    // record the displayed output (.avi, .mp4 or .raw)
+    int readbackDepth = 3;      // PBOs in the readback ring
+    bool streamingUpload = true;    // BGR frames go through alternating PBOs into fixed texture storage
+    bool persistentUpload = true;   // or through a persistently mapped buffer ring, where available
+    int textureRing = 3;        // video textures uploaded round-robin, 1 = a single texture
+    bool bc1 = false;           // compress BGR frames to BC1 on the CPU before uploading
+    int bc1Threads = 0;         // stripes for the BC1 encoder, 0 = OpenCV's default
+    bool mipmaps = true;        // mip levels for a minified quad, built only down to the sampled level
+    bool fusedWarp = false;     // CPU path: filter, warp and flip in one pass (sync and batch runs)
+    bool tiled = false;         // draw through a TiledTexture even if the frame fits one texture
+    int tileSize = 1024;
+    int tileBudgetMB = 512;     // GPU memory for resident tiles
+    vector<string> preload;     // image textures (BMP/DDS) loaded through the texture cache at startup
+    int cpuThreads = 0;         // threads of the CPU filter pool, 0 = one per hardware thread
+    int cpuTileWidth = 256;     // tiles the CPU filters and warps split a frame into
+    int cpuTileHeight = 32;
+    bool framePool = true;      // cv::Mat buffers recycled through a FramePool
+    HugePageMode hugePages = HUGE_PAGES_OFF;    // what backs the pool's frame-sized buffers
+    int httpPort = 0;           // MJPEG preview server, 0 = off
+    int httpThreads = 2;        // JPEG encoder threads of the preview server
+    int httpQuality = 80;
+    // offline processing (--process)
+    string offlineInput;
+    string offlineOutput = "processed.mp4";
+    bool offlineGPU = true;
+    FilterType offlineFilter = FILTER_NONE;
+    float offlineTransform[4] = { 0.0f, 0.0f, 0.0f, 1.0f };     // tx, ty (normalised), degrees, scale
+};
+AppOptions options;
+
+void printUsage(const char* exe) {
+    cout << "Usage: " << exe << " [options]\n"
+         << "  --source <spec>       webcam[:index] (default), v4l2[:device], file:<path>, raw:<path>\n"
+         << "                        or synthetic[:gradient|checker|noise]\n"
+         << "  --width <px>          requested frame width (default 1280)\n"
+         << "  --height <px>         requested frame height (default 720)\n"
+         << "  --fps <n>             capture rate; file/synthetic sources are paced to it, 0 = unpaced\n"
+         << "  --red-fraction <f>    synthetic: fraction of pixels that take the sinCity red branch\n"
+         << "  --red-band            synthetic: paint the red pixels as one band instead of scattering them\n"
+         << "  --mjpg                webcam: request MJPG and decode it on a worker pool\n"
+         << "  --decode-threads <n>  MJPG decode workers (default 2), 0 decodes on the capture thread\n"
+         << "  --yuv <yuyv|nv12>     v4l2/synthetic: keep frames in YUV, the GPU path converts in the shader\n"
+         << "  --record <path>       write every captured frame to a raw file for replay with --source raw:<path>\n"
+         << "  --sync                filter on the window thread instead of the latest-frame-wins worker\n"
+         << "  --shm <name>          publish every displayed frame into a shared-memory ring for local readers\n"
+         << "  --shm-slots <n>       slots in the shared-memory ring (default 8)\n"
+         << "  --direct-upload       upload BGR frames with glTexImage2D every frame instead of through PBOs\n"
+         << "  --no-persistent-upload  use the PBO streaming upload even where glBufferStorage is available\n"
+         << "  --texture-ring <n>    video textures used round-robin so uploads never wait for draws (default 3)\n"
+         << "  --bc1                 compress frames to BC1 (DXT1) on the CPU and upload them 6:1 smaller\n"
+         << "  --bc1-threads <n>     BC1 encoder stripes (default 0 = one per OpenCV worker)\n"
+         << "  --no-mipmaps          never build mip levels, also no CPU pre-shrink before minifying warps\n"
+         << "  --fused-warp          CPU path: filter, warp and flip each frame in one pass (with --sync and in --batch)\n"
+         << "  --tiled               stream frames as tiles (automatic above GL_MAX_TEXTURE_SIZE)\n"
+         << "  --tile-size <px>      tile edge length (default 1024)\n"
+         << "  --tile-budget <MB>    GPU memory for resident tiles (default 512)\n"
+         << "  --preload <image>     load a BMP/DDS texture at startup through the texture cache (repeatable)\n"
+         << "  --cpu-threads <n>     threads of the CPU filter/warp pool (default 0 = one per hardware thread)\n"
+         << "  --cpu-tile <w>x<h>    tile the CPU filters and warps work on (default 256x32)\n"
+         << "  --no-frame-pool       allocate cv::Mat buffers with malloc instead of recycling them\n"
+         << "  --huge-pages <mode>   frame pool buffers on huge pages: off (default), thp or explicit (Linux)\n"
+         << "  --record-output <path>  record what is displayed (.avi = MJPG, .raw = uncompressed, else mp4v)\n"
+         << "  --readback-depth <n>  PBOs used to read the output back without stalling (default 3)\n"
+         << "  --http <port>         serve the displayed output as MJPEG on http://<host>:<port>/stream\n"
+         << "  --http-threads <n>    JPEG encoder threads for --http (default 2)\n"
+         << "  --http-quality <q>    JPEG quality for --http (default 80)\n"
+         << "  --process <video>     offline mode: filter a video file as fast as possible, no window\n"
+         << "  --output <path>       offline output video (default processed.mp4)\n"
+         << "  --backend <cpu|gpu>   offline backend (default gpu, rendered offscreen)\n"
+         << "  --filter <name>       offline filter: none, pixelate or sincity\n"
+         << "  --transform <tx,ty,deg,scale>  offline affine transform (default 0,0,0,1)\n"
+         << "  --batch               run the automatic experiments immediately and exit\n"
+         << "  --batch-seconds <n>   duration of each experiment run (default 8)\n";
 }
 
-// Safe frame grab to avoid using frames with inconsistent step
-bool grabSafeFrame(cv::VideoCapture &cap, cv::Mat &frame) {
-    cap >> frame;
-    if (frame.empty()) {
-        return false;
-    }
-    if (frame.step < (size_t)frame.cols * (size_t)frame.elemSize1() * (size_t)frame.channels()) {
-        // invalid frame, consider it bad
-        return false;
+bool parseArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--source" && hasValue) {
+            if (!FrameSource::parseSpec(argv[++i], options.source)) {
+                cerr << "Error: unknown source '" << argv[i] << "'\n";
+                return false;
+            }
+        }
+        else if (arg == "--width" && hasValue) options.source.width = atoi(argv[++i]);
+        else if (arg == "--height" && hasValue) options.source.height = atoi(argv[++i]);
+        else if (arg == "--fps" && hasValue) options.source.fps = atof(argv[++i]);
+        else if (arg == "--red-fraction" && hasValue) options.source.redFraction = (float)atof(argv[++i]);
+        else if (arg == "--red-band") options.source.scatterRed = false;
+        else if (arg == "--mjpg") options.source.mjpg = true;
+        else if (arg == "--decode-threads" && hasValue) options.decodeThreads = atoi(argv[++i]);
+        else if (arg == "--yuv" && hasValue) options.source.yuv = argv[++i];
+        else if (arg == "--record" && hasValue) options.recordPath = argv[++i];
+        else if (arg == "--sync") options.asyncProcessing = false;
+        else if (arg == "--shm" && hasValue) {
+            options.shmName = argv[++i];
+            if (options.shmName[0] != '/') options.shmName = "/" + options.shmName;
+        }
+        else if (arg == "--shm-slots" && hasValue) options.shmSlots = atoi(argv[++i]);
+        else if (arg == "--record-output" && hasValue) options.recordOutputPath = argv[++i];
+        else if (arg == "--readback-depth" && hasValue) options.readbackDepth = atoi(argv[++i]);
+        else if (arg == "--direct-upload") options.streamingUpload = false;
+        else if (arg == "--no-persistent-upload") options.persistentUpload = false;
+        else if (arg == "--texture-ring" && hasValue) options.textureRing = atoi(argv[++i]);
+        else if (arg == "--bc1") options.bc1 = true;
+        else if (arg == "--bc1-threads" && hasValue) options.bc1Threads = atoi(argv[++i]);
+        else if (arg == "--no-mipmaps") options.mipmaps = false;
+        else if (arg == "--fused-warp") options.fusedWarp = true;
+        else if (arg == "--tiled") options.tiled = true;
+        else if (arg == "--tile-size" && hasValue) options.tileSize = atoi(argv[++i]);
+        else if (arg == "--tile-budget" && hasValue) options.tileBudgetMB = atoi(argv[++i]);
+        else if (arg == "--preload" && hasValue) options.preload.push_back(argv[++i]);
+        else if (arg == "--cpu-threads" && hasValue) options.cpuThreads = atoi(argv[++i]);
+        else if (arg == "--cpu-tile" && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &options.cpuTileWidth, &options.cpuTileHeight) != 2 ||
+                options.cpuTileWidth <= 0 || options.cpuTileHeight <= 0) { printUsage(argv[0]); return false; }
+        }
+        else if (arg == "--no-frame-pool") options.framePool = false;
+        else if (arg == "--huge-pages" && hasValue) {
+            string m = argv[++i];
+            if (m == "off") options.hugePages = HUGE_PAGES_OFF;
+            else if (m == "thp") options.hugePages = HUGE_PAGES_TRANSPARENT;
+            else if (m == "explicit") options.hugePages = HUGE_PAGES_EXPLICIT;
+            else { printUsage(argv[0]); return false; }
+        }
+        else if (arg == "--http" && hasValue) options.httpPort = atoi(argv[++i]);
+        else if (arg == "--http-threads" && hasValue) options.httpThreads = atoi(argv[++i]);
+        else if (arg == "--http-quality" && hasValue) options.httpQuality = atoi(argv[++i]);
+        else if (arg == "--process" && hasValue) options.offlineInput = argv[++i];
+        else if (arg == "--output" && hasValue) options.offlineOutput = argv[++i];
+        else if (arg == "--backend" && hasValue) {
+            string b = argv[++i];
+            if (b != "cpu" && b != "gpu") { printUsage(argv[0]); return false; }
+            options.offlineGPU = b == "gpu";
+        }
+        else if (arg == "--filter" && hasValue) {
+            string f = argv[++i];
+            if (f == "none") options.offlineFilter = FILTER_NONE;
+            else if (f == "pixelate") options.offlineFilter = FILTER_PIXELATE;
+            else if (f == "sincity") options.offlineFilter = FILTER_SINCITY;
+            else { printUsage(argv[0]); return false; }
+        }
+        else if (arg == "--transform" && hasValue) {
+            float* t = options.offlineTransform;
+            if (sscanf(argv[++i], "%f,%f,%f,%f", &t[0], &t[1], &t[2], &t[3]) != 4) { printUsage(argv[0]); return false; }
+        }
+        else if (arg == "--batch") options.batchOnly = true;
+        else if (arg == "--batch-seconds" && hasValue) options.batchSeconds = atoi(argv[++i]);
+        else {
+            printUsage(argv[0]);
+            return false;
+        }
     }
     return true;
 }
@@ -76,7 +242,7 @@ bool keyPressedOnce(int key) {
 }
 
 // -- Window + Input --
-bool initWindow(const std::string& name) {
+bool initWindow(const std::string& name, bool visible = true) {
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW\n";
         return false;
@@ -87,6 +253,7 @@ bool initWindow(const std::string& name) {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
     window = glfwCreateWindow(1024, 768, name.c_str(), nullptr, nullptr);
     if (!window) {
@@ -157,32 +324,1076 @@ void processInput() {
     }
 }
 
+// -- Frame upload --
+// BGR frames are copied once into a persistently mapped slot (the shader flips the rows) or flipped
+// while they are copied into a streaming PBO. YUV frames go up as their native planes
+// (2 or 1.5 bytes per pixel); the fragment shaders convert them and flip the rows.
+
+// BC1 upload (--bc1): BGR frames are compressed on the CPU and uploaded at 4 bits per pixel
+bool bc1Upload = false;     // --bc1 given and the driver has S3TC
+std::vector<uint8_t> bc1Blocks;
+
+bool uploadBC1(Texture* texture, const cv::Mat& bgr) {
+    if (!bc1Upload) return false;
+    BC1::encode(bgr, bc1Blocks, options.bc1Threads);
+    return texture->updateBC1(bc1Blocks.data(), bgr.cols, bgr.rows);
+}
+
+// Tiled streaming (--tiled, or frames larger than GL_MAX_TEXTURE_SIZE): frames go to a TiledTexture
+// instead of videoTexture and the quad uploads and draws only the visible tiles
+TiledTexture* tiledTexture = nullptr;
+
+// Picks the BGR upload path: a persistently mapped buffer ring where GL 4.4 / ARB_buffer_storage is
+// available (unless --no-persistent-upload), streaming PBOs otherwise; direct = glTexImage2D per frame
+string uploadModeName(const Texture* texture) {
+    if (bc1Upload) return "bc1";
+    return texture->persistentUpload() ? "persistent" : texture->streaming() ? "pbo" : "direct";
+}
+
+string configureUpload(Texture* texture, bool direct) {
+    texture->setPersistentUpload(false);
+    if (texture->streaming() != !direct) texture->setStreaming(!direct);
+    if (!direct && options.persistentUpload) texture->setPersistentUpload(true);
+    return uploadModeName(texture);
+}
+
+void uploadFrame(Texture* texture, const cv::Mat& frame, FramePixelFormat format, cv::Mat& flipped) {
+    if (tiledTexture) {
+        // the ring slot is recycled after release(), so BGR frames are copied
+        FrameSource::toBGR(frame, format, flipped);
+        tiledTexture->setImage(flipped, flipped.data == frame.data);
+    } else if (format == FRAME_YUYV) {
+        texture->updateYUYV(frame.data, frame.cols, frame.rows, (int)frame.step);
+    } else if (format == FRAME_NV12) {
+        texture->updateNV12(frame.data, frame.cols, frame.rows * 2 / 3, (int)frame.step);
+    } else if (!uploadBC1(texture, frame)) {
+        cv::Mat slot = texture->beginUpload(frame.cols, frame.rows);
+        if (!slot.empty()) {
+            // the one copy out of the capture ring goes straight into GL memory, unflipped
+            frame.copyTo(slot);
+            texture->commitUpload();
+        } else if (!texture->updateFlipped(frame.data, frame.cols, frame.rows, (int)frame.step)) {
+            // direct upload: flip into a client buffer first
+            cv::flip(frame, flipped, 0);
+            texture->update(flipped.data, flipped.cols, flipped.rows, true);
+        }
+    }
+}
+
+// -- CPU path --
+// Interactive transform applied by the CPU path's warp
+struct DisplayTransform {
+    float tx = 0.0f, ty = 0.0f, angle = 0.0f, scale = 1.0f;
+    bool valid = false;
+    bool operator==(const DisplayTransform& o) const {
+        return valid && o.valid && tx == o.tx && ty == o.ty && angle == o.angle && scale == o.scale;
+    }
+};
+
+DisplayTransform currentTransform() {
+    DisplayTransform t;
+    t.tx = translateX; t.ty = translateY; t.angle = rotateAngle; t.scale = scaleFactor;
+    t.valid = true;
+    return t;
+}
+
+// warpAffine matrix for a transform given in normalised units
+cv::Mat transformMatrix(cv::Size size, const DisplayTransform& t) {
+    cv::Point2f center(size.width/2.0f, size.height/2.0f);
+    cv::Mat M = cv::getRotationMatrix2D(center, t.angle, t.scale);
+    M.at<double>(0,2) += t.tx * size.width;
+    M.at<double>(1,2) -= t.ty * size.height;
+    return M;
+}
+
+// Warps a filtered frame with the interactive transform and flips it for upload
+void warpForDisplay(const cv::Mat& processed, const DisplayTransform& t, cv::Mat& rotated) {
+    CPUFilters::warp(processed, rotated, transformMatrix(processed.size(), t), processed.size());
+    cv::flip(rotated, rotated, 0);
+}
+
+// CPU mip level for a warp that scales by scale: the source is box-downsampled by 2 per level
+// first, so a minifying warpAffine (bilinear) does not skip over pixels
+int cpuMipLevel(double scale) {
+    if (!options.mipmaps || scale >= 1.0) return 0;
+    return std::min(4, (int)std::floor(std::log2(1.0 / scale)));
+}
+
+// Returns what to warp for M: src itself, or src reduced to the CPU mip level with M adjusted
+// so it maps the reduced image the way it mapped src
+const cv::Mat& prefilterWarp(const cv::Mat& src, double scale, cv::Mat& M, cv::Mat& reduced) {
+    const int level = cpuMipLevel(scale);
+    if (level == 0) return src;
+    CPUFilters::boxDownsample2x(src, reduced);
+    for (int l = 1; l < level; ++l) {
+        cv::Mat next;
+        CPUFilters::boxDownsample2x(reduced, next);
+        reduced = next;
+    }
+    // a reduced pixel x covers source pixels f*x .. f*x + f-1, centred on f*x + (f-1)/2
+    const double f = double(1 << level), o = (f - 1.0) / 2.0;
+    M = M.clone();
+    for (int r = 0; r < 2; ++r) {
+        double a = M.at<double>(r, 0), b = M.at<double>(r, 1);
+        M.at<double>(r, 2) += (a + b) * o;
+        M.at<double>(r, 0) = a * f;
+        M.at<double>(r, 1) = b * f;
+    }
+    return reduced;
+}
+
+// GPU mip level: from how far the quad is minified on screen under its current transform
+void updateMipLevel(Texture* texture, Quad* quad, Camera* cam) {
+    if (!options.mipmaps || texture->width() == 0) {
+        texture->setSampledLevel(0);
+        return;
+    }
+    int fbWidth = 0, fbHeight = 0;
+    glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+    float texelsPerPixel = quad->texelsPerPixel(cam, texture->width(), texture->height(), fbWidth, fbHeight);
+    texture->setSampledLevel(Texture::mipLevelFor(texelsPerPixel));
+}
+
+// Shared-memory output (--shm)
+SharedFrameWriter shmWriter;
+
+// Last step of the CPU path: warps a filtered frame, publishes it to shared memory and uploads it.
+// The warp writes straight into GL memory with a persistent upload ring, otherwise into the next
+// shared-memory slot or into rotated; a streaming texture then flips while copying, BC1 encodes it.
+// An identity transform, the usual case, skips the warp and uploads the filtered frame itself.
+void uploadProcessed(Texture* texture, const cv::Mat& processed, const DisplayTransform& t, cv::Mat& rotated,
+                     int64_t captureNs) {
+    cv::Mat M = transformMatrix(processed.size(), t);
+    cv::Mat reduced;
+    const cv::Mat& source = prefilterWarp(processed, t.scale, M, reduced);
+    cv::Mat slot = bc1Upload || tiledTexture ? cv::Mat() : texture->beginUpload(processed.cols, processed.rows);
+    if (!slot.empty()) {
+        cv::Mat shm;
+        if (shmWriter.isOpen()) shm = shmWriter.beginFrame(processed.cols, processed.rows, processed.type());
+        if (shm.empty()) {
+            CPUFilters::warp(source, slot, M, processed.size());
+        } else {
+            // the GL slot is mapped write-only, so the shared-memory copy is made from the other side
+            CPUFilters::warp(source, shm, M, processed.size());
+            shm.copyTo(slot);
+            shmWriter.commitFrame(captureNs);
+        }
+        texture->commitUpload();    // top-down, the shader flips
+        return;
+    }
+
+    cv::Mat shm;
+    if (shmWriter.isOpen()) shm = shmWriter.beginFrame(processed.cols, processed.rows, processed.type());
+    cv::Mat warped = processed;
+    // a pre-shrunk source always needs the warp back to full size, even where M became identity
+    if (!shm.empty() || source.data != processed.data || CPUFilters::classifyWarp(M) != CPUFilters::WARP_IDENTITY) {
+        cv::Mat& target = shm.empty() ? rotated : shm;
+        CPUFilters::warp(source, target, M, processed.size());
+        warped = target;
+    }
+    if (!shm.empty()) shmWriter.commitFrame(captureNs);
+    if (tiledTexture) {
+        // only rotated stays until the next frame; a shared-memory slot goes back to the readers
+        tiledTexture->setImage(warped, warped.data != rotated.data);
+        return;
+    }
+    if (uploadBC1(texture, warped)) return;
+    if (!texture->updateFlipped(warped.data, warped.cols, warped.rows, (int)warped.step)) {
+        cv::flip(warped, rotated, 0);
+        texture->update(rotated.data, rotated.cols, rotated.rows, true);
+    }
+}
+
+CPUFilters::Filter cpuFilterKind(FilterType f) {
+    return f == FILTER_PIXELATE ? CPUFilters::PIXELATE : (f == FILTER_SINCITY ? CPUFilters::SINCITY : CPUFilters::NONE);
+}
+
+// The CPU path in one pass (--fused-warp): filters and warps bgr, which may be a read-only ring
+// frame, straight into the upload destination, flipped only for the direct upload. Returns false
+// for a minifying warp, whose mip pre-shrink has to sit between filter and warp; the caller then
+// runs the filter and uploadProcessed.
+bool uploadFused(Texture* texture, const cv::Mat& bgr, FilterType f, const DisplayTransform& t, cv::Mat& rotated,
+                 int64_t captureNs) {
+    if (cpuMipLevel(t.scale) > 0) return false;
+    const CPUFilters::Filter filter = cpuFilterKind(f);
+    cv::Mat M = transformMatrix(bgr.size(), t);
+    cv::Mat shm;
+    if (shmWriter.isOpen()) shm = shmWriter.beginFrame(bgr.cols, bgr.rows, CV_8UC3);
+    cv::Mat slot = bc1Upload || tiledTexture ? cv::Mat() : texture->beginUpload(bgr.cols, bgr.rows);
+    if (!slot.empty()) {
+        // the GL slot is mapped write-only, so the shared-memory copy is made from the other side
+        CPUFilters::filterWarp(bgr, shm.empty() ? slot : shm, bgr.size(), filter, M, false);
+        if (!shm.empty()) {
+            shm.copyTo(slot);
+            shmWriter.commitFrame(captureNs);
+        }
+        texture->commitUpload();    // top-down, the shader flips
+        return true;
+    }
+
+    // shared memory, tiles, BC1 and streaming uploads take top-down rows, only the direct upload is flipped here
+    const bool flipRows = shm.empty() && !tiledTexture && !bc1Upload && !texture->streaming();
+    cv::Mat& out = shm.empty() ? rotated : shm;
+    CPUFilters::filterWarp(bgr, out, bgr.size(), filter, M, flipRows);
+    if (!shm.empty()) shmWriter.commitFrame(captureNs);
+    if (tiledTexture) {
+        tiledTexture->setImage(out, !shm.empty());
+        return true;
+    }
+    if (uploadBC1(texture, out)) return true;
+    if (!flipRows && texture->updateFlipped(out.data, out.cols, out.rows, (int)out.step)) return true;
+    if (!flipRows) cv::flip(out, rotated, 0);
+    texture->update(rotated.data, rotated.cols, rotated.rows, true);
+    return true;
+}
+
+// Output recording (--record-output)
+FrameEncoder outputEncoder;
+
+// MJPEG preview (--http)
+MjpegServer httpServer;
+
+// Receives finished PBO readbacks of the displayed frame (rows bottom-up)
+void deliverReadback(const cv::Mat& frame, int64_t captureNs) {
+    if (outputEncoder.isOpen()) outputEncoder.submit(frame, captureNs, true);
+    if (httpServer.wantsFrames()) httpServer.submit(frame, captureNs, true);
+    // the CPU path publishes to shared memory itself, before the upload
+    if (useGPU && shmWriter.isOpen()) {
+        cv::Mat slot = shmWriter.beginFrame(frame.cols, frame.rows, CV_8UC3);
+        if (slot.empty()) return;
+        cv::flip(frame, slot, 0);
+        shmWriter.commitFrame(captureNs);
+    }
+}
+
+// Filter step of the CPU path, used by the latest-frame-wins worker
+void cpuFilter(cv::Mat& frame, FramePixelFormat format, FilterType f, cv::Mat& out) {
+    cv::Mat bgr;
+    FrameSource::toBGR(frame, format, bgr);
+    if (f == FILTER_PIXELATE) CPUFilters::pixelate(bgr, out, 10);
+    else if (f == FILTER_SINCITY) CPUFilters::sinCity(bgr, out);
+    else bgr.copyTo(out);
+}
+
+int64_t steadyNowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// -- Shaders --
+// The default program is compiled at startup, the filter programs the first time they are used.
+struct FilterShaders {
+    Texture* texture = nullptr;
+    TextureShader* programs[3] = { nullptr, nullptr, nullptr };
+
+    TextureShader* get(FilterType f) {
+        if (!programs[f]) {
+            auto t0 = chrono::high_resolution_clock::now();
+            const char* frag = f == FILTER_PIXELATE ? "pixelate.frag"
+                             : (f == FILTER_SINCITY ? "sincity.frag" : "videoTextureShader.frag");
+            programs[f] = new TextureShader("videoTextureShader.vert", frag);
+            if (texture) programs[f]->setTexture(texture);
+            cout << "[MAIN] Compiled " << frag << " in " << fixed << setprecision(1)
+                 << chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count() << " ms\n";
+        }
+        return programs[f];
+    }
+    // same fragment shaders, drawn per tile (tiled streaming)
+    TileShader* getTile(FilterType f) {
+        if (!tilePrograms[f]) {
+            get(f);
+            const char* frag = f == FILTER_PIXELATE ? "pixelate.frag"
+                             : (f == FILTER_SINCITY ? "sincity.frag" : "videoTextureShader.frag");
+            tilePrograms[f] = new TileShader(frag);
+        }
+        return tilePrograms[f];
+    }
+    void setTexture(Texture* t) {
+        texture = t;
+        for (TextureShader* p : programs) if (p) p->setTexture(t);
+    }
+    // Deletes the programs; needs the GL context, so call it before glfwTerminate
+    void release() {
+        for (TextureShader*& p : programs) { delete p; p = nullptr; }
+        for (TileShader*& p : tilePrograms) { delete p; p = nullptr; }
+    }
+    ~FilterShaders() { release(); }
+    TileShader* tilePrograms[3] = { nullptr, nullptr, nullptr };
+};
+
+// Selects the filter program; in tiled mode the quad draws its tiles with the matching tile program
+void setQuadFilter(Quad* quad, FilterShaders& shaders, FilterType f) {
+    quad->setShader(shaders.get(f));
+    if (tiledTexture) quad->setTiles(tiledTexture, shaders.getTile(f));
+}
+
+// Time spent in each startup phase, printed and appended to startup_log.csv once the first
+// frame is on screen
+struct StartupTimes {
+    double sourceOpenMs = 0.0;      // background thread: open + camera warmup
+    double windowMs = 0.0;          // GLFW init and window/context creation
+    double glLoadMs = 0.0;          // glad + VAO
+    double shaderMs = 0.0;          // default program
+    double assetMs = 0.0;           // --preload textures: upload, plus any wait for their background parse
+    TextureCacheStats assets;
+    double sourceWaitMs = 0.0;      // main thread blocked on the source after its own init
+    double firstFrameWaitMs = 0.0;  // capture thread start until the first frame
+    double firstFrameMs = 0.0;      // process start until the first frame was presented
+};
+
+double msSince(chrono::high_resolution_clock::time_point t) {
+    return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t).count();
+}
+
+void reportStartup(const StartupTimes& t, const string& sourceName) {
+    cout << fixed << setprecision(1)
+         << "[MAIN] Startup: source open " << t.sourceOpenMs << " ms (background)"
+         << ", window " << t.windowMs << " ms, GL load " << t.glLoadMs << " ms"
+         << ", shaders " << t.shaderMs << " ms, waited for source " << t.sourceWaitMs << " ms"
+         << ", first frame wait " << t.firstFrameWaitMs << " ms"
+         << " -> first frame after " << t.firstFrameMs << " ms\n";
+    if (t.assets.requests > 0) {
+        cout << "[MAIN] Textures: " << t.assets.loaded << " loaded, " << t.assets.failed << " failed, "
+             << t.assets.duplicates << " duplicate requests, " << t.assets.bytesMapped / 1024 << " KB"
+             << ", parse " << t.assets.parseMs << " ms (background), upload " << t.assetMs << " ms\n";
+    }
+
+    ofstream csv("startup_log.csv", ios::app);
+    if (!csv.is_open()) return;
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "source,source_open_ms,window_ms,gl_load_ms,shader_ms,source_wait_ms,first_frame_wait_ms,time_to_first_frame_ms,"
+               "textures_loaded,texture_duplicates,texture_parse_ms,texture_upload_ms\n";
+    }
+    csv << fixed << setprecision(3) << sourceName << "," << t.sourceOpenMs << "," << t.windowMs << ","
+        << t.glLoadMs << "," << t.shaderMs << "," << t.sourceWaitMs << "," << t.firstFrameWaitMs << ","
+        << t.firstFrameMs << "," << t.assets.loaded << "," << t.assets.duplicates << "," << t.assets.parseMs << ","
+        << t.assetMs << "\n";
+}
+
 // -- Batch experiments --
+const char* filterName(FilterType f) {
+    return f==FILTER_NONE ? "NONE" : (f==FILTER_PIXELATE ? "PIXELATE" : "SINCITY");
+}
+
+// One configuration of the experiment matrix
+struct BatchRun {
+    int width, height;
+    bool useGPU;
+    FilterType filter;
+    bool transform;
+    float redFraction;      // content of a synthetic source, ignored otherwise
+    bool streamingUpload;   // default upload mode (see configureUpload), false = glTexImage2D every frame
+    float scale;            // zoom of the transform when it is on, < 1 minifies
+    CPUFilters::WarpClass warpClass;    // shape of the transform when it is on, see warpClassTransform
+    int threads;            // CPU pool threads, 0 = all
+};
+
+// Representative transform of each warp class at a given size: no-op, a whole-pixel shift,
+// a zoom about the centre, and the usual shift + 15 degree rotation + zoom
+DisplayTransform warpClassTransform(CPUFilters::WarpClass c, cv::Size size, float scale) {
+    DisplayTransform t;
+    t.valid = true;
+    if (c == CPUFilters::WARP_TRANSLATE) {
+        t.tx = 64.0f / size.width;
+        t.ty = 32.0f / size.height;
+    } else if (c == CPUFilters::WARP_SCALE) {
+        t.scale = scale;
+    } else if (c == CPUFilters::WARP_GENERAL) {
+        t.tx = 0.10f; t.ty = 0.05f; t.angle = 15.0f; t.scale = scale;
+    }
+    return t;
+}
+
+// Builds the list of runs. Runs are grouped by resolution so the source is only reconfigured
+// when the resolution changes.
+vector<BatchRun> buildBatchPlan(bool syntheticSource, float defaultRedFraction) {
+    const vector<pair<int,int>> resolutions = { {1280,720}, {1024,576}, {640,360} };
+    const vector<int> backends = { 0 /*GPU*/, 1 /*CPU*/ };
+    const vector<FilterType> filters = { FILTER_NONE, FILTER_PIXELATE, FILTER_SINCITY };
+    const vector<bool> transformFlags = { false, true };
+    // With a synthetic source, Sin City is also swept over image content, since its cost
+    // depends on how many pixels take the red branch.
+    const vector<float> sinCityContents = { 0.0f, 0.5f, 1.0f };
+
+    const vector<float> zoomedOut = { 0.5f, 0.25f };
+    vector<int> threadCounts;
+    for (int n = 1; n < WorkStealingPool::shared().threads(); n *= 2) threadCounts.push_back(n);
+    // the CPU warp's cheaper kernels; the runs above are all general
+    const vector<pair<CPUFilters::WarpClass, float>> warpClasses = {
+        { CPUFilters::WARP_IDENTITY, 1.0f }, { CPUFilters::WARP_TRANSLATE, 1.0f }, { CPUFilters::WARP_SCALE, 1.5f } };
+
+    vector<BatchRun> plan;
+    for (auto res : resolutions) {
+        for (int backend : backends)
+            for (auto f : filters) {
+                vector<float> contents = { defaultRedFraction };
+                if (syntheticSource && f == FILTER_SINCITY) contents = sinCityContents;
+                for (float redFraction : contents)
+                    for (bool transformActive : transformFlags) {
+                        plan.push_back({ res.first, res.second, backend == 0, f, transformActive, redFraction, true, 0.9f,
+                                         CPUFilters::WARP_GENERAL, 0 });
+                        // upload cost does not depend on the transform, so direct upload is only
+                        // compared on the untransformed GPU runs
+                        if (backend == 0 && !transformActive)
+                            plan.push_back({ res.first, res.second, true, f, false, redFraction, false, 1.0f,
+                                             CPUFilters::WARP_GENERAL, 0 });
+                    }
+            }
+        // zoomed out: the cost of mip levels (GPU) and of the pre-shrink (CPU) when the quad is minified
+        for (int backend : backends)
+            for (float zoom : zoomedOut)
+                plan.push_back({ res.first, res.second, backend == 0, FILTER_NONE, true, defaultRedFraction, true, zoom,
+                                 CPUFilters::WARP_GENERAL, 0 });
+        for (auto wc : warpClasses)
+            plan.push_back({ res.first, res.second, false, FILTER_NONE, true, defaultRedFraction, true, wc.second, wc.first, 0 });
+        // scaling curve of the CPU path: 1, 2, 4 ... threads; the runs above use all of them
+        for (auto f : filters)
+            for (int threads : threadCounts)
+                plan.push_back({ res.first, res.second, false, f, true, defaultRedFraction, true, 0.9f,
+                                 CPUFilters::WARP_GENERAL, threads });
+    }
+    return plan;
+}
+
+// Compares serial cv::imdecode against the JpegDecodePool on JPEGs of the current capture size.
+// The corpus is encoded from captured frames so every source can run it. Appends to decode_experiments.csv.
+void runDecodeBenchmark(CaptureThread& capture, int w, int h, const string& build_type) {
+    const int corpusSize = 30;
+    const int passes = 4;
+    const string csvName = "decode_experiments.csv";
+
+    vector<cv::Mat> corpus;
+    vector<uchar> encoded;
+    const vector<int> params = { cv::IMWRITE_JPEG_QUALITY, 90 };
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while ((int)corpus.size() < corpusSize && chrono::steady_clock::now() < deadline) {
+        FrameSlot* slot = capture.acquireLatest();
+        if (!slot) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        cv::imencode(".jpg", slot->frame, encoded, params);
+        capture.release();
+        corpus.push_back(cv::Mat(encoded, true));
+    }
+    if (corpus.empty()) return;
+
+    const int frames = (int)corpus.size() * passes;
+    cv::Mat decoded;
+
+    // serial: one decode after another on this thread
+    auto t0 = chrono::high_resolution_clock::now();
+    for (int p = 0; p < passes; ++p)
+        for (const cv::Mat& jpeg : corpus) cv::imdecode(jpeg, cv::IMREAD_COLOR, &decoded);
+    double serialSec = chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count();
+
+    // pooled: same frames through the pool, in-order delivery included
+    int threads = max(2, (int)std::thread::hardware_concurrency());
+    int delivered = 0;
+    double pooledSec = 0.0;
+    {
+        JpegDecodePool pool(threads, (size_t)(2 * threads), [&delivered](cv::Mat&, int64_t) { ++delivered; });
+        t0 = chrono::high_resolution_clock::now();
+        for (int p = 0; p < passes; ++p)
+            for (const cv::Mat& jpeg : corpus) {
+                cv::Mat copy = jpeg;
+                while (!pool.submit(std::move(copy), 0)) {
+                    copy = jpeg;
+                    std::this_thread::yield();
+                }
+            }
+        pool.flush();
+        pooledSec = chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count();
+    }
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,mode,threads,frames,avg_fps,avg_frame_time_ms,avg_jpeg_kb,build_type\n";
+    }
+    size_t totalBytes = 0;
+    for (const cv::Mat& jpeg : corpus) totalBytes += jpeg.total();
+    double avgKb = totalBytes / 1024.0 / corpus.size();
+
+    csv << fixed << setprecision(3)
+        << w << "," << h << ",SERIAL,1," << frames << "," << frames / serialSec << ","
+        << serialSec * 1000.0 / frames << "," << avgKb << "," << build_type << "\n"
+        << w << "," << h << ",POOLED," << threads << "," << delivered << "," << delivered / pooledSec << ","
+        << pooledSec * 1000.0 / max(delivered, 1) << "," << avgKb << "," << build_type << "\n";
+
+    cout << "[BATCH] decode " << w << "x" << h << " serial_fps=" << frames / serialSec
+         << " pooled_fps=" << delivered / pooledSec << " (" << threads << " threads)\n";
+}
+
+// Measures what recording the GPU output costs per frame: no recording, a synchronous glReadPixels
+// and the PBO ring, each feeding the encoder thread. Runs without vsync so the frame time is the
+// real work. Appends to recording_experiments.csv.
+void runRecordingBenchmark(CaptureThread& capture, Texture* videoTexture, Quad* quad, Scene* scene, Camera* cam,
+                           FilterShaders& shaders, int w, int h, const string& build_type) {
+    const double runSeconds = max(2, options.batchSeconds / 2);
+    const string csvName = "recording_experiments.csv";
+    const string tempVideo = "recording_benchmark.avi";
+    const char* modes[] = { "OFF", "SYNC", "PBO" };
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,mode,readback_depth,frames,avg_frame_time_ms,readback_ms,overhead_pct,"
+               "frames_encoded,frames_dropped,build_type\n";
+    }
+
+    const FramePixelFormat pixelFormat = capture.source().pixelFormat();
+    cv::Mat flipped, syncFrame;
+    int fbWidth = 0, fbHeight = 0;
+    glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+    glfwSwapInterval(0);
+
+    double baselineMs = 0.0;
+    for (int mode = 0; mode < 3; ++mode) {
+        FrameReadback readback(options.readbackDepth);
+        FrameEncoder encoder;
+        if (mode > 0) encoder.open(tempVideo, 30.0);
+        auto submit = [&encoder](const cv::Mat& frame, int64_t captureNs) { encoder.submit(frame, captureNs, true); };
+
+        uint64_t frames = 0;
+        double frameMsSum = 0.0, readbackMsSum = 0.0;
+        auto tEnd = chrono::high_resolution_clock::now() + chrono::duration<double>(runSeconds);
+        while (chrono::high_resolution_clock::now() < tEnd && !glfwWindowShouldClose(window)) {
+            FrameSlot* slot = capture.acquireLatest();
+            if (!slot) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            auto frameStart = chrono::high_resolution_clock::now();
+            const int64_t captureNs = slot->captureTimeNs;
+            uploadFrame(videoTexture, slot->frame, pixelFormat, flipped);
+            capture.release();
+            setQuadFilter(quad, shaders, FILTER_SINCITY);
+            quad->setTranslate(glm::vec3(0.10f, 0.05f, 0.0f));
+            quad->setRotate(15.0f);
+            quad->setScale(0.9f);
+
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scene->render(cam);
+
+            auto readbackStart = chrono::high_resolution_clock::now();
+            if (mode == 1) {
+                syncFrame.create(fbHeight, fbWidth, CV_8UC3);
+                glPixelStorei(GL_PACK_ALIGNMENT, 1);
+                glReadPixels(0, 0, fbWidth, fbHeight, GL_BGR, GL_UNSIGNED_BYTE, syncFrame.data);
+                encoder.submit(syncFrame, captureNs, true);
+            } else if (mode == 2) {
+                readback.collect(submit);
+                readback.queue(fbWidth, fbHeight, captureNs);
+            }
+            readbackMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - readbackStart).count();
+
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+            frameMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+            ++frames;
+        }
+        readback.collect(submit, true);
+        encoder.close();
+        EncoderStats enc = encoder.stats();
+        uint64_t dropped = enc.dropped + readback.stats().skipped;
+
+        double avgFrameMs = frames ? frameMsSum / frames : 0.0;
+        double avgReadbackMs = frames ? readbackMsSum / frames : 0.0;
+        if (mode == 0) baselineMs = avgFrameMs;
+        double overheadPct = baselineMs > 0.0 ? (avgFrameMs - baselineMs) / baselineMs * 100.0 : 0.0;
+
+        csv << fixed << setprecision(3)
+            << w << "," << h << "," << modes[mode] << "," << (mode == 2 ? readback.depth() : 0) << ","
+            << frames << "," << avgFrameMs << "," << avgReadbackMs << "," << overheadPct << ","
+            << enc.encoded << "," << dropped << "," << build_type << "\n";
+        cout << "[BATCH] recording " << w << "x" << h << " " << modes[mode]
+             << " frame_ms=" << avgFrameMs << " readback_ms=" << avgReadbackMs
+             << " overhead=" << overheadPct << "% encoded=" << enc.encoded << " dropped=" << dropped << "\n";
+    }
+    std::remove(tempVideo.c_str());
+    glfwSwapInterval(1);
+}
+
+// Renders the GPU path (Sin City, transform on, no vsync) as fast as it goes with texture rings of
+// depth 1 to 4. The newest captured frame is re-uploaded every iteration, so throughput does not
+// depend on the camera rate. Latency is upload start to the GPU finishing the draw (fence).
+// Appends to texture_ring_experiments.csv.
+void runTextureRingBenchmark(CaptureThread& capture, Texture* videoTexture, Quad* quad, Scene* scene, Camera* cam,
+                             FilterShaders& shaders, int w, int h, const string& build_type) {
+    const double runSeconds = max(2, options.batchSeconds / 2);
+    const string csvName = "texture_ring_experiments.csv";
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,ring_depth,upload_mode,frames,avg_fps,avg_frame_time_ms,avg_upload_ms,"
+               "avg_latency_ms,build_type\n";
+    }
+
+    const FramePixelFormat pixelFormat = capture.source().pixelFormat();
+    cv::Mat source, flipped;
+    glfwSwapInterval(0);
+    setQuadFilter(quad, shaders, FILTER_SINCITY);
+    quad->setTranslate(glm::vec3(0.10f, 0.05f, 0.0f));
+    quad->setRotate(15.0f);
+    quad->setScale(0.9f);
+
+    for (int depth = 1; depth <= 4; ++depth) {
+        videoTexture->setRingDepth(depth);
+        struct InFlight { GLsync fence; chrono::high_resolution_clock::time_point start; };
+        std::deque<InFlight> inFlight;
+        uint64_t frames = 0, completed = 0;
+        double frameMsSum = 0.0, uploadMsSum = 0.0, latencyMsSum = 0.0;
+        auto collect = [&](bool wait) {
+            while (!inFlight.empty()) {
+                GLenum r = glClientWaitSync(inFlight.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000ull : 0);
+                if (r == GL_TIMEOUT_EXPIRED) break;
+                latencyMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - inFlight.front().start).count();
+                ++completed;
+                glDeleteSync(inFlight.front().fence);
+                inFlight.pop_front();
+            }
+        };
+
+        auto runStart = chrono::high_resolution_clock::now();
+        auto tEnd = runStart + chrono::duration<double>(runSeconds);
+        while (chrono::high_resolution_clock::now() < tEnd && !glfwWindowShouldClose(window)) {
+            if (FrameSlot* slot = capture.acquireLatest()) {
+                slot->frame.copyTo(source);
+                capture.release();
+            }
+            if (source.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            auto frameStart = chrono::high_resolution_clock::now();
+            uploadFrame(videoTexture, source, pixelFormat, flipped);
+            uploadMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scene->render(cam);
+            inFlight.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), frameStart });
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+            collect(false);
+
+            frameMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+            ++frames;
+        }
+        collect(true);
+        double elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - runStart).count();
+
+        double avgFps = frames / elapsed;
+        double avgFrameMs = frames ? frameMsSum / frames : 0.0;
+        double avgUploadMs = frames ? uploadMsSum / frames : 0.0;
+        double avgLatencyMs = completed ? latencyMsSum / completed : 0.0;
+        csv << fixed << setprecision(3)
+            << w << "," << h << "," << depth << "," << uploadModeName(videoTexture) << "," << frames << ","
+            << avgFps << "," << avgFrameMs << "," << avgUploadMs << "," << avgLatencyMs << "," << build_type << "\n";
+        cout << "[BATCH] texture ring " << w << "x" << h << " depth=" << depth << " fps=" << avgFps
+             << " upload_ms=" << avgUploadMs << " latency_ms=" << avgLatencyMs << "\n";
+    }
+    videoTexture->setRingDepth(options.textureRing);
+    glfwSwapInterval(1);
+}
+
+// Compares uncompressed uploads with BC1: the scalar and the SIMD block encoder on one stripe, and the
+// SIMD encoder on all stripes. Each mode re-uploads the newest captured frame for a few seconds;
+// upload time runs to glFinish so it includes the transfer BC1 shrinks. PSNR is measured on the last
+// encoded frame against the source. Appends to compression_experiments.csv.
+void runCompressionBenchmark(CaptureThread& capture, Texture* videoTexture, Quad* quad, Scene* scene, Camera* cam,
+                             FilterShaders& shaders, int w, int h, const string& build_type) {
+    if (capture.source().pixelFormat() != FRAME_BGR24 || !Texture::compressedUploadSupported()) return;
+    const double runSeconds = max(2, options.batchSeconds / 2);
+    const string csvName = "compression_experiments.csv";
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,mode,encoder_threads,frames,avg_fps,avg_encode_ms,avg_upload_ms,"
+               "avg_total_ms,bytes_per_frame,compression_ratio,psnr_db,build_type\n";
+    }
+
+    struct Mode { const char* name; bool compress; bool simd; int threads; };
+    const Mode modes[] = {
+        { "uncompressed", false, false, 0 },
+        { "bc1-scalar", true, false, 1 },
+        { "bc1-simd", true, true, 1 },
+        { "bc1-simd-mt", true, true, 0 },
+    };
+    const bool savedBC1 = bc1Upload;
+    bc1Upload = false;
+    cv::Mat source, flipped, decoded;
+    std::vector<uint8_t> blocks;
+    glfwSwapInterval(0);
+    setQuadFilter(quad, shaders, FILTER_NONE);
+    quad->setTranslate(glm::vec3(0.0f));
+    quad->setRotate(0.0f);
+    quad->setScale(1.0f);
+
+    for (const Mode& mode : modes) {
+        if (mode.compress && mode.simd && !BC1::simdAvailable()) continue;
+        uint64_t frames = 0;
+        double encodeMsSum = 0.0, uploadMsSum = 0.0, totalMsSum = 0.0;
+        auto runStart = chrono::high_resolution_clock::now();
+        auto tEnd = runStart + chrono::duration<double>(runSeconds);
+        while (chrono::high_resolution_clock::now() < tEnd && !glfwWindowShouldClose(window)) {
+            if (FrameSlot* slot = capture.acquireLatest()) {
+                slot->frame.copyTo(source);
+                capture.release();
+            }
+            if (source.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            auto frameStart = chrono::high_resolution_clock::now();
+            if (mode.compress) {
+                BC1::encode(source, blocks, mode.threads, mode.simd);
+                auto uploadStart = chrono::high_resolution_clock::now();
+                encodeMsSum += chrono::duration<double, milli>(uploadStart - frameStart).count();
+                videoTexture->updateBC1(blocks.data(), source.cols, source.rows);
+                glFinish();
+                uploadMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - uploadStart).count();
+            } else {
+                uploadFrame(videoTexture, source, FRAME_BGR24, flipped);
+                glFinish();
+                uploadMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+            }
+            totalMsSum += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - frameStart).count();
+
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scene->render(cam);
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+            ++frames;
+        }
+        double elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - runStart).count();
+
+        const size_t rawBytes = (size_t)w * h * 3;
+        const size_t bytes = mode.compress ? BC1::compressedSize(w, h) : rawBytes;
+        string psnr;
+        if (mode.compress && !blocks.empty() && !source.empty()) {
+            BC1::decode(blocks.data(), source.cols, source.rows, decoded);
+            std::ostringstream out;
+            out << fixed << setprecision(2) << cv::PSNR(source, decoded);
+            psnr = out.str();
+        }
+        double avgFps = elapsed > 0.0 ? frames / elapsed : 0.0;
+        double avgEncodeMs = frames ? encodeMsSum / frames : 0.0;
+        double avgUploadMs = frames ? uploadMsSum / frames : 0.0;
+        double avgTotalMs = frames ? totalMsSum / frames : 0.0;
+        csv << fixed << setprecision(3)
+            << w << "," << h << "," << mode.name << "," << (mode.compress ? mode.threads : 0) << "," << frames << ","
+            << avgFps << "," << avgEncodeMs << "," << avgUploadMs << "," << avgTotalMs << "," << bytes << ","
+            << (double)rawBytes / bytes << "," << psnr << "," << build_type << "\n";
+        cout << "[BATCH] compression " << w << "x" << h << " " << mode.name << " encode_ms=" << avgEncodeMs
+             << " upload_ms=" << avgUploadMs << " bytes=" << bytes << " psnr=" << (psnr.empty() ? "-" : psnr) << "\n";
+    }
+    bc1Upload = savedBC1;
+    glfwSwapInterval(1);
+}
+
+// Bytes that differ between two images of the same size and type, and optionally the largest difference
+int64_t countMismatchedBytes(const cv::Mat& a, const cv::Mat& b, int* maxDiff = nullptr) {
+    if (maxDiff) *maxDiff = 0;
+    if (a.size() != b.size() || a.type() != b.type()) {
+        if (maxDiff) *maxDiff = 255;
+        return (int64_t)a.total() * a.elemSize();
+    }
+    int64_t count = 0;
+    const size_t rowBytes = a.cols * a.elemSize();
+    for (int y = 0; y < a.rows; ++y) {
+        const uchar* pa = a.ptr<uchar>(y);
+        const uchar* pb = b.ptr<uchar>(y);
+        for (size_t i = 0; i < rowBytes; ++i) {
+            int d = std::abs((int)pa[i] - (int)pb[i]);
+            count += d != 0;
+            if (maxDiff && d > *maxDiff) *maxDiff = d;
+        }
+    }
+    return count;
+}
+
+// Up to count BGR copies of captured frames, for the CPU benchmarks
+vector<cv::Mat> captureBGRCorpus(CaptureThread& capture, int count) {
+    vector<cv::Mat> corpus;
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while ((int)corpus.size() < count && chrono::steady_clock::now() < deadline) {
+        FrameSlot* slot = capture.acquireLatest();
+        if (!slot) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        cv::Mat bgr;
+        FrameSource::toBGR(slot->frame, capture.source().pixelFormat(), bgr);
+        corpus.push_back(bgr.clone());
+        capture.release();
+    }
+    return corpus;
+}
+
+// Times the CPU filter kernels against the original implementations on captured frames of the
+// current size and checks that they produce the same bytes. Appends to filter_kernels.csv.
+void runFilterKernelBenchmark(CaptureThread& capture, int w, int h, const string& build_type) {
+    const int passes = 5;
+    const string csvName = "filter_kernels.csv";
+
+    const vector<cv::Mat> corpus = captureBGRCorpus(capture, 10);
+    if (corpus.empty()) return;
+
+    struct Kernel {
+        FilterType filter;
+        string name;
+        int threads;    // 0 = OpenCV's default
+        std::function<void(const cv::Mat&, cv::Mat&)> run;
+    };
+    vector<Kernel> kernels;
+    kernels.push_back({ FILTER_SINCITY, "reference", 1,
+                        [](const cv::Mat& src, cv::Mat& dst) { CPUFilters::sinCityReference(src, dst); } });
+    for (int level = CPUFilters::SIMD_NONE; level <= CPUFilters::simdLevel(); ++level) {
+        for (int threads : { 1, 0 }) {
+            CPUFilters::SimdLevel simd = (CPUFilters::SimdLevel)level;
+            kernels.push_back({ FILTER_SINCITY, string(CPUFilters::simdName(simd)) + (threads == 1 ? "" : "-mt"), threads,
+                                [simd, threads](const cv::Mat& src, cv::Mat& dst) { CPUFilters::sinCity(src, dst, simd, threads); } });
+        }
+    }
+    kernels.push_back({ FILTER_PIXELATE, "reference", 1,
+                        [](const cv::Mat& src, cv::Mat& dst) { CPUFilters::pixelateReference(src, dst, 10); } });
+    for (int level = CPUFilters::SIMD_NONE; level <= CPUFilters::simdLevel(); ++level) {
+        for (int threads : { 1, 0 }) {
+            CPUFilters::SimdLevel simd = (CPUFilters::SimdLevel)level;
+            // the pixelate column sums only need SSE2 below AVX2
+            string name = simd == CPUFilters::SIMD_SSSE3 ? "sse2" : CPUFilters::simdName(simd);
+            kernels.push_back({ FILTER_PIXELATE, name + (threads == 1 ? "" : "-mt"), threads,
+                                [simd, threads](const cv::Mat& src, cv::Mat& dst) { CPUFilters::pixelate(src, dst, 10, simd, threads); } });
+        }
+    }
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,filter,kernel,threads,frames,avg_ms,speedup,mismatched_bytes,build_type\n";
+    }
+
+    // the first kernel of each filter is its reference: its output and time are what the rest are measured against
+    vector<cv::Mat> expected(corpus.size());
+    cv::Mat out;
+    FilterType referenceFilter = FILTER_NONE;
+    double referenceMs = 0.0;
+    for (const Kernel& kernel : kernels) {
+        const bool isReference = kernel.filter != referenceFilter;
+        auto t0 = chrono::high_resolution_clock::now();
+        for (int p = 0; p < passes; ++p)
+            for (const cv::Mat& frame : corpus) kernel.run(frame, out);
+        double avgMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count() / (passes * corpus.size());
+
+        int64_t mismatched = 0;
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            kernel.run(corpus[i], out);
+            if (isReference) {
+                out.copyTo(expected[i]);
+            } else {
+                mismatched += countMismatchedBytes(out, expected[i]);
+            }
+        }
+        if (isReference) {
+            referenceFilter = kernel.filter;
+            referenceMs = avgMs;
+        }
+        double speedup = avgMs > 0.0 ? referenceMs / avgMs : 0.0;
+        csv << fixed << setprecision(3)
+            << w << "," << h << "," << filterName(kernel.filter) << "," << kernel.name << "," << kernel.threads << ","
+            << passes * corpus.size() << "," << avgMs << "," << speedup << "," << mismatched << "," << build_type << "\n";
+        cout << "[BATCH] kernel " << w << "x" << h << " " << filterName(kernel.filter) << " " << kernel.name
+             << " avg_ms=" << avgMs << " speedup=" << speedup << "x"
+             << (mismatched ? " MISMATCH bytes=" + std::to_string(mismatched) : string()) << "\n";
+    }
+}
+
+// Compares the CPU path's chain (filter into a frame, cv::warpAffine into another, cv::flip) with
+// the fused filterWarp pass for each filter under a rotate + zoom + shift transform, on captured
+// frames of the current size. Traffic is the frames each stage reads and writes, counted from the
+// stage list. Appends to fused_warp_experiments.csv.
+void runFusedWarpBenchmark(CaptureThread& capture, int w, int h, const string& build_type) {
+    const int passes = 5;
+    const string csvName = "fused_warp_experiments.csv";
+
+    const vector<cv::Mat> corpus = captureBGRCorpus(capture, 10);
+    if (corpus.empty()) return;
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,filter,stage,frames,avg_ms,speedup,frame_traffic_mb,mismatched_bytes,max_abs_diff,build_type\n";
+    }
+
+    DisplayTransform t;
+    t.tx = 0.10f; t.ty = 0.05f; t.angle = 15.0f; t.scale = 1.1f;
+    t.valid = true;
+    const cv::Mat M = transformMatrix(corpus[0].size(), t);
+    const double frameMB = corpus[0].total() * 3 / (1024.0 * 1024.0);
+    const int frames = passes * (int)corpus.size();
+
+    for (FilterType f : { FILTER_NONE, FILTER_PIXELATE, FILTER_SINCITY }) {
+        // chain: the filter reads and writes a frame (none for FILTER_NONE), warp and flip one each
+        cv::Mat processed, warped;
+        vector<cv::Mat> chained(corpus.size());
+        auto t0 = chrono::high_resolution_clock::now();
+        for (int p = 0; p < passes; ++p) {
+            for (size_t i = 0; i < corpus.size(); ++i) {
+                if (f == FILTER_PIXELATE) CPUFilters::pixelate(corpus[i], processed, 10, CPUFilters::simdLevel());
+                else if (f == FILTER_SINCITY) CPUFilters::sinCity(corpus[i], processed, CPUFilters::simdLevel());
+                else processed = corpus[i];
+                cv::warpAffine(processed, warped, M, processed.size());
+                cv::flip(warped, chained[i], 0);
+            }
+        }
+        const double chainMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count() / frames;
+        const double chainMB = frameMB * (f == FILTER_NONE ? 4 : 6);
+
+        // fused: one write; pixelate reads the frame once for its block means, sinCity once at the taps
+        cv::Mat out;
+        int64_t mismatched = 0;
+        int maxDiff = 0;
+        t0 = chrono::high_resolution_clock::now();
+        for (int p = 0; p < passes; ++p)
+            for (const cv::Mat& frame : corpus) CPUFilters::filterWarp(frame, out, frame.size(), cpuFilterKind(f), M, true);
+        const double fusedMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count() / frames;
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            CPUFilters::filterWarp(corpus[i], out, corpus[i].size(), cpuFilterKind(f), M, true);
+            int diff = 0;
+            mismatched += countMismatchedBytes(out, chained[i], &diff);
+            maxDiff = max(maxDiff, diff);
+        }
+        const double fusedMB = frameMB * 2;
+
+        csv << fixed << setprecision(3)
+            << w << "," << h << "," << filterName(f) << ",chain," << frames << "," << chainMs << ",1.000,"
+            << chainMB << ",0,0," << build_type << "\n"
+            << w << "," << h << "," << filterName(f) << ",fused," << frames << "," << fusedMs << ","
+            << (fusedMs > 0.0 ? chainMs / fusedMs : 0.0) << "," << fusedMB << "," << mismatched << "," << maxDiff << ","
+            << build_type << "\n";
+        cout << "[BATCH] fused warp " << w << "x" << h << " " << filterName(f) << " chain_ms=" << chainMs
+             << " fused_ms=" << fusedMs << " traffic_mb=" << chainMB << "->" << fusedMB
+             << " mismatched=" << mismatched << " max_diff=" << maxDiff << "\n";
+    }
+}
+
+// Times cv::warpAffine, the forced general kernel and CPUFilters::warp's dispatch on the
+// representative transform of each warp class, on captured frames of the current size, and counts
+// the bytes that differ from warpAffine. Appends to warp_experiments.csv.
+void runWarpBenchmark(CaptureThread& capture, int w, int h, const string& build_type) {
+    const int passes = 5;
+    const string csvName = "warp_experiments.csv";
+
+    const vector<cv::Mat> corpus = captureBGRCorpus(capture, 10);
+    if (corpus.empty()) return;
+
+    ofstream csv(csvName, ios::app);
+    if (!csv.is_open()) {
+        std::cerr << "[BATCH] Cannot open " << csvName << " for writing\n";
+        return;
+    }
+    csv.seekp(0, ios::end);
+    if (csv.tellp() == 0) {
+        csv << "resolution_w,resolution_h,warp_class,kernel,frames,avg_ms,speedup,mismatched_bytes,max_abs_diff,build_type\n";
+    }
+
+    const int frames = passes * (int)corpus.size();
+    const pair<CPUFilters::WarpClass, float> classes[] = {
+        { CPUFilters::WARP_IDENTITY, 1.0f }, { CPUFilters::WARP_TRANSLATE, 1.0f },
+        { CPUFilters::WARP_SCALE, 1.5f }, { CPUFilters::WARP_GENERAL, 1.1f } };
+    for (const auto& wc : classes) {
+        const cv::Mat M = transformMatrix(corpus[0].size(), warpClassTransform(wc.first, corpus[0].size(), wc.second));
+        const CPUFilters::WarpClass dispatched = CPUFilters::classifyWarp(M);
+        vector<cv::Mat> expected(corpus.size());
+        for (size_t i = 0; i < corpus.size(); ++i) cv::warpAffine(corpus[i], expected[i], M, corpus[i].size());
+
+        struct Kernel { const char* name; std::function<void(const cv::Mat&, cv::Mat&)> run; };
+        const Kernel kernels[] = {
+            { "warpAffine", [&](const cv::Mat& s, cv::Mat& d) { cv::warpAffine(s, d, M, s.size()); } },
+            { "general", [&](const cv::Mat& s, cv::Mat& d) { CPUFilters::warp(s, d, M, s.size(), CPUFilters::WARP_GENERAL); } },
+            { "dispatch", [&](const cv::Mat& s, cv::Mat& d) { CPUFilters::warp(s, d, M, s.size()); } },
+        };
+        double baselineMs = 0.0;
+        for (const Kernel& kernel : kernels) {
+            cv::Mat out;
+            auto t0 = chrono::high_resolution_clock::now();
+            for (int p = 0; p < passes; ++p)
+                for (const cv::Mat& frame : corpus) kernel.run(frame, out);
+            const double avgMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count() / frames;
+            if (baselineMs == 0.0) baselineMs = avgMs;
+            int64_t mismatched = 0;
+            int maxDiff = 0;
+            for (size_t i = 0; i < corpus.size(); ++i) {
+                kernel.run(corpus[i], out);
+                int diff = 0;
+                mismatched += countMismatchedBytes(out, expected[i], &diff);
+                maxDiff = max(maxDiff, diff);
+            }
+            const double speedup = avgMs > 0.0 ? baselineMs / avgMs : 0.0;
+
+            csv << fixed << setprecision(3)
+                << w << "," << h << "," << CPUFilters::warpClassName(dispatched) << "," << kernel.name << ","
+                << frames << "," << avgMs << "," << speedup << "," << mismatched << "," << maxDiff << ","
+                << build_type << "\n";
+            cout << "[BATCH] warp " << w << "x" << h << " " << CPUFilters::warpClassName(dispatched) << " "
+                 << kernel.name << " avg_ms=" << avgMs << " speedup=" << speedup << "x"
+                 << (mismatched ? " MISMATCH bytes=" + std::to_string(mismatched) : string()) << "\n";
+        }
+    }
+}
+
 // Runs a set of experiments, logs averaged FPS per run to a experiments.csv file.
 void runBatchExperiments(
-    cv::VideoCapture &cap,
+    CaptureThread &capture,
     Texture* videoTexture,
     Quad* quad,
     Scene* scene,
     Camera* cam,
-    TextureShader* defaultShader,
-    TextureShader* pixelateShader,
-    TextureShader* sinCityShader
+    FilterShaders& shaders
 ) {
     batchRunning = true;
     std::cout << "[MAIN] Running automatic experiments (T pressed)\n";
+    // compile the filter programs up front so the first run of each filter is not charged for it
+    for (FilterType f : { FILTER_NONE, FILTER_PIXELATE, FILTER_SINCITY }) shaders.get(f);
     // Config
-    const vector<pair<int,int>> resolutions = { {1280,720}, {1024,576}, {640,360} };
-    const vector<int> backends = { 0 /*GPU*/, 1 /*CPU*/ };
-    const vector<FilterType> filters = { FILTER_NONE, FILTER_PIXELATE, FILTER_SINCITY };
-    const vector<bool> transformFlags = { false, true };
+    SyntheticSource* synthetic = dynamic_cast<SyntheticSource*>(&capture.source());
+    const float origRedFraction = synthetic ? synthetic->redFraction() : 0.0f;
+    const string sourceName = capture.source().name();
+    const vector<BatchRun> plan = buildBatchPlan(synthetic != nullptr, origRedFraction);
+    WorkStealingPool& cpuPool = WorkStealingPool::shared();
 
-    const int runSeconds = 8;
+    const int runSeconds = options.batchSeconds;
     const int warmupMs = 400; 
     const string csvName = "experiments.csv";
 
-    double origW = cap.get(cv::CAP_PROP_FRAME_WIDTH);
-    double origH = cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+    cv::Size origSize = capture.resolution();
 
     // open CSV
     ofstream csv(csvName, ios::app);
@@ -194,7 +1405,7 @@ void runBatchExperiments(
     // write header if new file
     csv.seekp(0, ios::end);
     if (csv.tellp() == 0) {
-        csv << "resolution_w,resolution_h,backend,filter,transform,avg_fps,run_seconds,build_type,avg_frame_time_ms\n";
+        csv << "resolution_w,resolution_h,backend,filter,transform,avg_fps,run_seconds,build_type,avg_frame_time_ms,frames_captured,frames_consumed,frames_dropped,source,red_fraction,capture_backend,upload_mode,avg_upload_ms,scale,mip_level,cpu_stage,warp_class,mat_allocs_per_frame,os_allocs_per_frame,cpu_threads,pool_utilization\n";
     }
 
     #ifdef NDEBUG
@@ -204,301 +1415,809 @@ void runBatchExperiments(
     #endif
 
     // iterate configs
-    for (auto res : resolutions) {
-        int w = res.first, h = res.second;
-        // set camera resolution
-        cap.set(cv::CAP_PROP_FRAME_WIDTH, w);
-        cap.set(cv::CAP_PROP_FRAME_HEIGHT, h);
-
-      
-        std::this_thread::sleep_for(std::chrono::milliseconds(warmupMs));
-        for (int d=0; d<6; ++d) {
-            cv::Mat tmp; cap >> tmp;
-            std::this_thread::sleep_for(std::chrono::milliseconds(8));
+    cv::Size currentSize;
+    bool sizeSupported = false;
+    for (const BatchRun& run : plan) {
+        if (glfwWindowShouldClose(window)) break;
+        const int w = run.width, h = run.height;
+
+        if (currentSize != cv::Size(w, h)) {
+            // set camera resolution
+            sizeSupported = capture.setResolution(w, h) || capture.resolution() == cv::Size(w, h);
+            currentSize = cv::Size(w, h);
+            if (!sizeSupported) {
+                cout << "[BATCH] Source " << sourceName << " cannot deliver " << w << "x" << h << ", skipping\n";
+                continue;
+            }
+
+            // let the camera settle, then throw away whatever is still queued at the old size
+            std::this_thread::sleep_for(std::chrono::milliseconds(warmupMs));
+            for (int d=0; d<6; ++d) {
+                capture.acquireLatest();
+                capture.release();
+                std::this_thread::sleep_for(std::chrono::milliseconds(8));
+            }
+            runDecodeBenchmark(capture, w, h, build_type);
+            runRecordingBenchmark(capture, videoTexture, quad, scene, cam, shaders, w, h, build_type);
+            runTextureRingBenchmark(capture, videoTexture, quad, scene, cam, shaders, w, h, build_type);
+            runCompressionBenchmark(capture, videoTexture, quad, scene, cam, shaders, w, h, build_type);
+            runFilterKernelBenchmark(capture, w, h, build_type);
+            runFusedWarpBenchmark(capture, w, h, build_type);
+            runWarpBenchmark(capture, w, h, build_type);
+            // the benchmark corpora and buffers of the previous size would otherwise stay cached
+            if (FramePool::installed()) FramePool::installed()->trim();
         }
-
-        for (int backend : backends) {
-            for (auto f : filters) {
-                for (bool transformActive : transformFlags) {
-                    if (glfwWindowShouldClose(window)) break;
-
-                    cout << "[BATCH] Running: " << w << "x" << h
-                         << " backend=" << (backend==0 ? "GPU" : "CPU")
-                         << " filter=" << (f==FILTER_NONE ? "NONE" : (f==FILTER_PIXELATE ? "PIXELATE" : "SINCITY"))
-                         << " transform=" << (transformActive ? "ON" : "OFF")
-                         << " for " << runSeconds << "s\n";
-
-                    // prepare run variables
-                    bool localUseGPU = (backend == 0);
-                    // representative transform for transform ON:
-                    const float txNorm = transformActive ? 0.10f : 0.0f;
-                    const float tyNorm = transformActive ? 0.05f : 0.0f;
-                    const float rotDeg  = transformActive ? 15.0f : 0.0f;
-                    const float scl     = transformActive ? 0.9f : 1.0f;
-
-                    // per-run stats
-                    uint64_t frames = 0;
-                    double totalFrameMs = 0.0;
-
-                    auto tEnd = chrono::high_resolution_clock::now() + chrono::seconds(runSeconds);
-
-                    // run loop
-                    while (chrono::high_resolution_clock::now() < tEnd) {
-                        auto frameStart = chrono::high_resolution_clock::now();
-
-                        cv::Mat frame;
-                        cap >> frame;
-                        if (frame.empty()) {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-                            continue;
+        if (!sizeSupported) continue;
+        if (synthetic) synthetic->setRedFraction(run.redFraction);
+
+        const FilterType f = run.filter;
+        const bool transformActive = run.transform;
+
+        configureUpload(videoTexture, !run.streamingUpload);
+        cout << "[BATCH] Running: " << w << "x" << h
+             << " backend=" << (run.useGPU ? "GPU" : "CPU")
+             << " filter=" << filterName(f)
+             << " transform=" << (transformActive ? "ON" : "OFF")
+             << " upload=" << uploadModeName(videoTexture);
+        if (transformActive) cout << " scale=" << run.scale << " warp=" << CPUFilters::warpClassName(run.warpClass);
+        if (!run.useGPU) cout << " threads=" << (run.threads > 0 ? run.threads : cpuPool.threads());
+        if (synthetic) cout << " red_fraction=" << run.redFraction;
+        cout << " for " << runSeconds << "s\n";
+
+        // prepare run variables
+        bool localUseGPU = run.useGPU;
+        // representative transform of the run's warp class for transform ON:
+        const DisplayTransform shape = warpClassTransform(run.warpClass, cv::Size(w, h), run.scale);
+        const float txNorm = transformActive ? shape.tx : 0.0f;
+        const float tyNorm = transformActive ? shape.ty : 0.0f;
+        const float rotDeg  = transformActive ? shape.angle : 0.0f;
+        const float scl     = transformActive ? shape.scale : 1.0f;
+        // kernel the CPU warp dispatched to, logged for transform ON
+        CPUFilters::WarpClass warpClass = CPUFilters::WARP_IDENTITY;
+        // level sampled by the GPU path at the end of the run, or the CPU path's pre-shrink level
+        int mipLevel = localUseGPU ? 0 : cpuMipLevel(scl);
+        // the fused CPU stage leaves minifying warps to the chain, which pre-shrinks
+        const bool fused = !localUseGPU && options.fusedWarp && mipLevel == 0;
+
+        // per-run stats
+        uint64_t frames = 0;
+        double totalFrameMs = 0.0, totalUploadMs = 0.0;
+        CaptureStats statsStart = capture.stats();
+        const FramePoolStats poolStart = FramePool::installed() ? FramePool::installed()->stats() : FramePoolStats();
+        cpuPool.setActiveThreads(run.threads);
+        const int cpuThreads = cpuPool.activeThreads();
+        const PoolStats cpuPoolStart = cpuPool.stats();
+        const FramePixelFormat pixelFormat = capture.source().pixelFormat();
+        cv::Mat flipped, rotated;
+
+        auto tEnd = chrono::high_resolution_clock::now() + chrono::seconds(runSeconds);
+
+        // run loop
+        while (chrono::high_resolution_clock::now() < tEnd) {
+            FrameSlot* slot = capture.acquireLatest();
+            if (!slot) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            cv::Mat& frame = slot->frame;
+
+            auto frameStart = chrono::high_resolution_clock::now();
+
+            if (localUseGPU) {
+                auto uploadStart = chrono::high_resolution_clock::now();
+                uploadFrame(videoTexture, frame, pixelFormat, flipped);
+                totalUploadMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - uploadStart).count();
+                // shader selection
+                setQuadFilter(quad, shaders, f);
+                // apply transform to quad as normalized values
+                quad->setTranslate(glm::vec3(txNorm, tyNorm, 0.0f));
+                quad->setRotate(rotDeg);
+                quad->setScale(scl);
+
+            } else {
+                // CPU path: filter + warp if transformActive, in one pass with --fused-warp
+                cv::Mat bgr, processed;
+                FrameSource::toBGR(frame, pixelFormat, bgr);
+                if (fused) {
+                    // filter, warp and upload in one pass; the whole stage counts as upload time
+                    auto uploadStart = chrono::high_resolution_clock::now();
+                    DisplayTransform t;
+                    t.tx = txNorm; t.ty = tyNorm; t.angle = rotDeg; t.scale = scl;
+                    t.valid = true;
+                    uploadFused(videoTexture, bgr, f, t, rotated, 0);
+                    totalUploadMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - uploadStart).count();
+                } else {
+                    if (f == FILTER_PIXELATE) CPUFilters::pixelate(bgr, processed, 10);
+                    else if (f == FILTER_SINCITY) CPUFilters::sinCity(bgr, processed);
+                    else processed = bgr;
+
+                    // with a persistent upload ring the warp writes straight into GL memory
+                    auto slotStart = chrono::high_resolution_clock::now();
+                    cv::Mat uploadSlot = bc1Upload || tiledTexture ? cv::Mat() : videoTexture->beginUpload(processed.cols, processed.rows);
+                    totalUploadMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - slotStart).count();
+                    if (transformActive) {
+                        float txPixels = txNorm * processed.cols;
+                        float tyPixels = tyNorm * processed.rows;
+                        cv::Point2f center(processed.cols/2.0f, processed.rows/2.0f);
+                        cv::Mat M = cv::getRotationMatrix2D(center, rotDeg, scl);
+                        M.at<double>(0,2) += txPixels;
+                        M.at<double>(1,2) -= tyPixels;
+                        warpClass = CPUFilters::classifyWarp(M);
+                        // identity leaves the frame as it is, the upload below copies it where it has to go
+                        if (warpClass != CPUFilters::WARP_IDENTITY) {
+                            cv::Mat warped = uploadSlot, reduced;
+                            const cv::Mat& warpSource = prefilterWarp(processed, scl, M, reduced);
+                            warpClass = CPUFilters::warp(warpSource, warped, M, processed.size());
+                            processed = warped;
                         }
+                    }
+
+                    auto uploadStart = chrono::high_resolution_clock::now();
+                    if (!uploadSlot.empty()) {
+                        if (processed.data != uploadSlot.data) processed.copyTo(uploadSlot);
+                        videoTexture->commitUpload();
+                    } else if (tiledTexture) {
+                        tiledTexture->setImage(processed, true);
+                    } else if (uploadBC1(videoTexture, processed)) {
+                        // compressed top-down, the shader flips
+                    } else if (!videoTexture->updateFlipped(processed.data, processed.cols, processed.rows, (int)processed.step)) {
+                        // the direct path flips in place, ring frames are read-only
+                        if (processed.data == frame.data) processed = frame.clone();
+                        cv::flip(processed, processed, 0);
+                        videoTexture->update(processed.data, processed.cols, processed.rows, true);
+                    }
+                    totalUploadMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - uploadStart).count();
+                }
+
+                // CPU uses default shader and identity quad transform so image shows as-warped
+                setQuadFilter(quad, shaders, FILTER_NONE);
+                quad->setTranslate(glm::vec3(0.0f,0.0f,0.0f));
+                quad->setRotate(0.0f);
+                quad->setScale(1.0f);
+            }
+            capture.release();
+
+            updateMipLevel(videoTexture, quad, cam);
+            if (localUseGPU) mipLevel = videoTexture->sampledLevel();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scene->render(cam);
+            glFinish();
+
+            glfwSwapBuffers(window);
+            glfwPollEvents();
 
-                        if (localUseGPU) {
-                            cv::flip(frame, frame, 0);
-                            videoTexture->update(frame.data, frame.cols, frame.rows, true);
-                            // shader selection
-                            if (f == FILTER_PIXELATE) quad->setShader(pixelateShader);
-                            else if (f == FILTER_SINCITY) quad->setShader(sinCityShader);
-                            else quad->setShader(defaultShader);
-                            // apply transform to quad as normalized values
-                            quad->setTranslate(glm::vec3(txNorm, tyNorm, 0.0f));
-                            quad->setRotate(rotDeg);
-                            quad->setScale(scl);
-
-                        } else {
-                            // CPU path: filter + warpAffine if transformActive
-                            cv::Mat processed;
-                            if (f == FILTER_PIXELATE) CPUFilters::pixelate(frame, processed, 10);
-                            else if (f == FILTER_SINCITY) CPUFilters::sinCity(frame, processed);
-                            else processed = frame.clone();
-
-                            if (transformActive) {
-                                float txPixels = txNorm * processed.cols;
-                                float tyPixels = tyNorm * processed.rows;
-                                cv::Point2f center(processed.cols/2.0f, processed.rows/2.0f);
-                                cv::Mat M = cv::getRotationMatrix2D(center, rotDeg, scl);
-                                M.at<double>(0,2) += txPixels;
-                                M.at<double>(1,2) -= tyPixels;
-                                cv::Mat warped;
-                                cv::warpAffine(processed, warped, M, processed.size());
-                                processed = std::move(warped);
-                            }
-
-                            cv::flip(processed, processed, 0);
-                            videoTexture->update(processed.data, processed.cols, processed.rows, true);
-
-                            // CPU uses default shader and identity quad transform so image shows as-warped
-                            quad->setShader(defaultShader);
-                            quad->setTranslate(glm::vec3(0.0f,0.0f,0.0f));
-                            quad->setRotate(0.0f);
-                            quad->setScale(1.0f);
-                        }
+            frames++;
+            auto frameEnd = chrono::high_resolution_clock::now();
+            double frameMs = chrono::duration<double, milli>(frameEnd - frameStart).count();
+            totalFrameMs += frameMs;
 
-                        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-                        scene->render(cam);
-                        glFinish();
-
-                        glfwSwapBuffers(window);
-                        glfwPollEvents();
-
-                        frames++;
-                        auto frameEnd = chrono::high_resolution_clock::now();
-                        double frameMs = chrono::duration<double, milli>(frameEnd - frameStart).count();
-                        totalFrameMs += frameMs;
-
-                        if (glfwWindowShouldClose(window)) break;
-                    } // per-config loop
-
-                    // compute results
-                    double avgFps = frames > 0 ? double(frames) / double(runSeconds) : 0.0;
-                    double avgFrameMs = frames > 0 ? totalFrameMs / double(frames) : 0.0;
-
-                    csv << w << "," << h << "," << (localUseGPU ? "GPU" : "CPU") << ","
-                        << (f==FILTER_NONE ? "NONE" : (f==FILTER_PIXELATE ? "PIXELATE" : "SINCITY")) << ","
-                        << (transformActive ? "ON" : "OFF") << ","
-                        << fixed << setprecision(3) << avgFps << ","
-                        << runSeconds << "," << build_type << ","
-                        << fixed << setprecision(3) << avgFrameMs << "\n";
-                    csv.flush();
-
-                    cout << "[BATCH] result -> " << w << "x" << h << " "
-                         << (localUseGPU ? "GPU" : "CPU") << " "
-                         << (f==FILTER_NONE ? "NONE" : (f==FILTER_PIXELATE ? "PIXELATE" : "SINCITY"))
-                         << " transform=" << (transformActive ? "ON" : "OFF")
-                         << " avg_fps=" << avgFps << " avg_frame_ms=" << avgFrameMs << "\n";
-
-                    std::this_thread::sleep_for(std::chrono::milliseconds(120));
-                    if (glfwWindowShouldClose(window)) break;
-                } // transform flags
-                if (glfwWindowShouldClose(window)) break;
-            } // filters
             if (glfwWindowShouldClose(window)) break;
-        } // backends
-        if (glfwWindowShouldClose(window)) break;
-    } // resolutions
+        } // per-config loop
+
+        // compute results
+        CaptureStats runStats = capture.stats() - statsStart;
+        double avgFps = frames > 0 ? double(frames) / double(runSeconds) : 0.0;
+        double avgFrameMs = frames > 0 ? totalFrameMs / double(frames) : 0.0;
+        double avgUploadMs = frames > 0 ? totalUploadMs / double(frames) : 0.0;
+        const FramePoolStats poolRun = (FramePool::installed() ? FramePool::installed()->stats() : FramePoolStats()) - poolStart;
+        double matAllocs = frames > 0 ? double(poolRun.allocations) / double(frames) : 0.0;
+        double osAllocs = frames > 0 ? double(poolRun.systemAllocations) / double(frames) : 0.0;
+        // busy share of the pool threads this run used: its first cpuThreads - 1 workers and the callers
+        const PoolStats cpuPoolRun = cpuPool.stats() - cpuPoolStart;
+        const double poolUtilization = cpuPoolRun.averageUtilization(cpuThreads - 1);
+
+        csv << w << "," << h << "," << (localUseGPU ? "GPU" : "CPU") << ","
+            << filterName(f) << ","
+            << (transformActive ? "ON" : "OFF") << ","
+            << fixed << setprecision(3) << avgFps << ","
+            << runSeconds << "," << build_type << ","
+            << fixed << setprecision(3) << avgFrameMs << ","
+            << runStats.captured << "," << runStats.consumed << "," << runStats.dropped << ","
+            << sourceName << ",";
+        if (synthetic) csv << run.redFraction;
+        csv << "," << capture.source().backendName() << ","
+            << uploadModeName(videoTexture) << "," << avgUploadMs << "," << scl << "," << mipLevel << ","
+            << (localUseGPU ? "" : (fused ? "fused" : "chain")) << ","
+            << (localUseGPU || fused || !transformActive ? "" : CPUFilters::warpClassName(warpClass)) << ",";
+        if (FramePool::installed()) csv << matAllocs << "," << osAllocs;
+        csv << ",";
+        if (!localUseGPU) csv << cpuThreads << "," << poolUtilization;
+        csv << "\n";
+        csv.flush();
+
+        cout << "[BATCH] result -> " << w << "x" << h << " "
+             << (localUseGPU ? "GPU" : "CPU") << " "
+             << filterName(f)
+             << " transform=" << (transformActive ? "ON" : "OFF")
+             << " avg_fps=" << avgFps << " avg_frame_ms=" << avgFrameMs << " upload_ms=" << avgUploadMs
+             << " captured=" << runStats.captured << " consumed=" << runStats.consumed
+             << " dropped=" << runStats.dropped;
+        if (FramePool::installed()) cout << " mat_allocs/frame=" << matAllocs << " os_allocs/frame=" << osAllocs;
+        cout << "\n";
+        if (!localUseGPU) {
+            cout << "[BATCH] pool threads=" << cpuThreads << " utilization=" << fixed << setprecision(1) << poolUtilization * 100.0 << "%:";
+            for (int i = 0; i < cpuThreads - 1; ++i)
+                cout << " w" << i << "=" << cpuPoolRun.workers[i].utilization * 100.0 << "% (" << cpuPoolRun.workers[i].stolen << " stolen)";
+            cout << " caller=" << cpuPoolRun.callers.utilization * 100.0 << "%\n";
+        }
 
-    // restore camera original resolution
-    cap.set(cv::CAP_PROP_FRAME_WIDTH, (int)origW);
-    cap.set(cv::CAP_PROP_FRAME_HEIGHT, (int)origH);
+        std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    } // runs
+
+    // restore camera original resolution and content
+    cpuPool.setActiveThreads(0);
+    capture.setResolution(origSize.width, origSize.height);
+    if (synthetic) synthetic->setRedFraction(origRedFraction);
+    configureUpload(videoTexture, !options.streamingUpload);
 
     csv.close();
     cout << "[BATCH] Finished automatic experiments. Results appended to " << csvName << "\n";
     batchRunning = false;
 }
 
-// ---------------------- main ----------------------
-int main() {
-    // open camera
-    cv::VideoCapture cap(0);
-    if (!cap.isOpened()) {
-        cerr << "Error: could not open camera\n";
+// -- Offline processing --
+// Reads a video file as fast as possible, filters and transforms every frame on the CPU path or
+// the GPU path (rendered into an offscreen target and read back) and writes the result.
+// No window is shown and nothing waits for vsync. Appends a summary to offline_experiments.csv.
+int runOfflineProcessing() {
+    const string& inputPath = options.offlineInput;
+    cv::VideoCapture input(inputPath);
+    if (!input.isOpened()) {
+        cerr << "Error: could not open " << inputPath << "\n";
         return -1;
     }
+    const int w = (int)input.get(cv::CAP_PROP_FRAME_WIDTH);
+    const int h = (int)input.get(cv::CAP_PROP_FRAME_HEIGHT);
+    double fps = input.get(cv::CAP_PROP_FPS);
+    if (fps <= 0.0) fps = 30.0;
+
+    cv::VideoWriter output(options.offlineOutput, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), fps, cv::Size(w, h));
+    if (!output.isOpened()) {
+        cerr << "Error: could not create " << options.offlineOutput << "\n";
+        return -1;
+    }
+
+    const bool gpu = options.offlineGPU;
+    const FilterType filter = options.offlineFilter;
+    DisplayTransform transform;
+    transform.tx = options.offlineTransform[0];
+    transform.ty = options.offlineTransform[1];
+    transform.angle = options.offlineTransform[2];
+    transform.scale = options.offlineTransform[3];
+    transform.valid = true;
+    const bool transformActive = transform.tx != 0.0f || transform.ty != 0.0f ||
+                                 transform.angle != 0.0f || transform.scale != 1.0f;
+
+    // GPU resources live in a hidden window's context; the frame is rendered into an FBO
+    FilterShaders shaders;
+    Texture* texture = nullptr;
+    Quad* quad = nullptr;
+    Camera* cam = nullptr;
+    RenderTarget* target = nullptr;
+    GLuint VAO = 0;
+    // also runs when the GPU setup fails half way, so everything it touches may still be unset
+    auto releaseGPU = [&]() {
+        delete target;
+        delete cam;
+        delete quad;
+        delete texture;
+        shaders.release();
+        if (VAO) glDeleteVertexArrays(1, &VAO);
+        glfwTerminate();
+    };
+    if (gpu) {
+        if (!initWindow("Offline processing", false) || !gladLoadGL(glfwGetProcAddress)) {
+            releaseGPU();
+            return -1;
+        }
+        glEnable(GL_DEPTH_TEST);
+        glGenVertexArrays(1, &VAO); glBindVertexArray(VAO);
+
+        float aspectRatio = (float)w / (float)h;
+        texture = new Texture(w, h);
+        configureUpload(texture, !options.streamingUpload);
+        texture->setRingDepth(options.textureRing);
+        shaders.setTexture(texture);
+        quad = new Quad(aspectRatio);
+        quad->setShader(shaders.get(filter));
+        quad->setTranslate(glm::vec3(transform.tx, transform.ty, 0.0f));
+        quad->setRotate(transform.angle);
+        quad->setScale(transform.scale);
+        // orthographic camera so the untransformed quad covers the target exactly
+        cam = new Camera(glm::ortho(-aspectRatio, aspectRatio, -1.0f, 1.0f, -10.0f, 10.0f), glm::mat4(1.0f));
+        target = new RenderTarget(w, h);
+        if (!target->isComplete()) {
+            releaseGPU();
+            return -1;
+        }
+    }
+
+    cout << "[OFFLINE] " << inputPath << " (" << w << "x" << h << ") -> " << options.offlineOutput
+         << " backend=" << (gpu ? "GPU" : "CPU") << " filter=" << filterName(filter)
+         << " transform=" << (transformActive ? "ON" : "OFF") << "\n";
+
+    cv::Mat frame, filtered, warped, flipped, readback(h, w, CV_8UC3), result;
+    double readMs = 0.0, processMs = 0.0, writeMs = 0.0;
+    uint64_t frames = 0;
+    auto start = chrono::high_resolution_clock::now();
+
+    for (;;) {
+        auto t0 = chrono::high_resolution_clock::now();
+        if (!input.read(frame) || frame.empty()) break;
+        auto t1 = chrono::high_resolution_clock::now();
+
+        if (gpu) {
+            uploadFrame(texture, frame, FRAME_BGR24, flipped);
+            target->bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            quad->render(cam);
+            // GL rows are bottom-up
+            target->readPixels(readback.data, (int)readback.step);
+            cv::flip(readback, result, 0);
+        } else {
+            cpuFilter(frame, FRAME_BGR24, filter, filtered);
+            if (transformActive) {
+                CPUFilters::warp(filtered, warped, transformMatrix(filtered.size(), transform), filtered.size());
+                result = warped;
+            } else {
+                result = filtered;
+            }
+        }
+        auto t2 = chrono::high_resolution_clock::now();
+
+        output.write(result);
+        auto t3 = chrono::high_resolution_clock::now();
+
+        readMs += chrono::duration<double, milli>(t1 - t0).count();
+        processMs += chrono::duration<double, milli>(t2 - t1).count();
+        writeMs += chrono::duration<double, milli>(t3 - t2).count();
+        if (++frames % 100 == 0) cout << "[OFFLINE] " << frames << " frames\n";
+    }
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    double throughput = seconds > 0.0 ? frames / seconds : 0.0;
+    output.release();
+
+    cout << "[OFFLINE] " << frames << " frames in " << fixed << setprecision(2) << seconds << " s -> "
+         << throughput << " fps (read " << readMs / max<uint64_t>(frames, 1) << " ms, process "
+         << processMs / max<uint64_t>(frames, 1) << " ms, write " << writeMs / max<uint64_t>(frames, 1)
+         << " ms per frame)\n";
+
+    #ifdef NDEBUG
+    const string build_type = "Release";
+    #else
+    const string build_type = "Debug";
+    #endif
+    const string csvName = "offline_experiments.csv";
+    ofstream csv(csvName, ios::app);
+    if (csv.is_open()) {
+        csv.seekp(0, ios::end);
+        if (csv.tellp() == 0) {
+            csv << "input,resolution_w,resolution_h,backend,filter,transform,frames,seconds,avg_fps,read_ms,process_ms,write_ms,build_type\n";
+        }
+        csv << inputPath << "," << w << "," << h << "," << (gpu ? "GPU" : "CPU") << "," << filterName(filter) << ","
+            << (transformActive ? "ON" : "OFF") << "," << frames << "," << fixed << setprecision(3) << seconds << ","
+            << throughput << "," << readMs / max<uint64_t>(frames, 1) << "," << processMs / max<uint64_t>(frames, 1) << ","
+            << writeMs / max<uint64_t>(frames, 1) << "," << build_type << "\n";
+    }
 
-    // 
-    cap.set(cv::CAP_PROP_FRAME_WIDTH, 1280);
-    cap.set(cv::CAP_PROP_FRAME_HEIGHT, 720);
-    cap.set(cv::CAP_PROP_FPS, 30);
+    if (gpu) releaseGPU();
+    return 0;
+}
 
-    if (!warmupCamera(cap, 80, 15)) {
-        cerr << "[WARN] Camera warmup failed to get frames quickly — continuing anyway\n";
+// ---------------------- main ----------------------
+int main(int argc, char** argv) {
+    if (!parseArguments(argc, argv)) return -1;
+    // before any thread creates Mats, so every frame buffer of the pipeline comes from the pool
+    WorkStealingPool::configure(options.cpuThreads, options.cpuTileWidth, options.cpuTileHeight);
+    if (options.framePool) {
+        FramePool::install(options.hugePages);
+        cout << "[MAIN] Frame pool on, huge pages " << FramePool::hugePageModeName(FramePool::installed()->hugePages()) << "\n";
+    }
+    if (!options.offlineInput.empty()) return runOfflineProcessing();
+    auto processStart = chrono::high_resolution_clock::now();
+    StartupTimes startup;
+
+    // Open the frame source (webcam by default) in the background; camera warmup is the
+    // slowest part of startup and does not need the GL context.
+    FrameSource* source = FrameSource::create(options.source);
+    if (!source) {
+        cerr << "Error: unknown frame source\n";
+        return -1;
+    }
+    std::future<bool> sourceOpened = std::async(std::launch::async, [source, &startup]() {
+        auto t0 = chrono::high_resolution_clock::now();
+        bool ok = source->open();
+        startup.sourceOpenMs = msSince(t0);
+        return ok;
+    });
+    // Image textures are mapped and parsed on their own workers while the window is created
+    TextureCache textures;
+    for (const string& path : options.preload) textures.request(path);
+
+    auto t0 = chrono::high_resolution_clock::now();
+    bool windowOk = initWindow("Video Processing");
+    startup.windowMs = msSince(t0);
+    t0 = chrono::high_resolution_clock::now();
+    bool glOk = windowOk && gladLoadGL(glfwGetProcAddress);
+    GLuint VAO = 0;
+    if (glOk) {
+        glEnable(GL_DEPTH_TEST);
+        glGenVertexArrays(1, &VAO); glBindVertexArray(VAO);
+    }
+    startup.glLoadMs = msSince(t0);
+
+    FilterShaders shaders;
+    if (glOk) {
+        t0 = chrono::high_resolution_clock::now();
+        shaders.get(FILTER_NONE);
+        startup.shaderMs = msSince(t0);
+        t0 = chrono::high_resolution_clock::now();
+        for (const string& path : options.preload) textures.get(path);
+        startup.assetMs = msSince(t0);
+        startup.assets = textures.stats();
     }
 
-    if (!initWindow("Video Processing")) return -1;
-    if (!gladLoadGL(glfwGetProcAddress)) return -1;
+    t0 = chrono::high_resolution_clock::now();
+    bool sourceOk = sourceOpened.get();
+    startup.sourceWaitMs = msSince(t0);
+    if (!glOk || !sourceOk) {
+        if (!sourceOk) cerr << "Error: could not open frame source\n";
+        delete source;
+        textures.clear();
+        shaders.release();
+        glfwTerminate();
+        return -1;
+    }
+    cout << "[MAIN] Frame source: " << source->name() << " (" << source->backendName() << ")\n";
+
+    // From here on the source is only read on the capture thread
+    CaptureThread capture(*source);
+    capture.setDecodeThreads(options.decodeThreads);
 
-    glEnable(GL_DEPTH_TEST);
-    GLuint VAO; glGenVertexArrays(1, &VAO); glBindVertexArray(VAO);
+    RawFrameWriter recorder;
+    if (!options.recordPath.empty() && source->pixelFormat() == FRAME_NV12) {
+        cerr << "[WARN] Raw recordings cannot hold NV12 frames, --record ignored\n";
+    }
+    else if (!options.recordPath.empty() && recorder.open(options.recordPath)) {
+        capture.setFrameCallback([&recorder](const cv::Mat& frame, int64_t captureTimeNs) {
+            recorder.append(frame, captureTimeNs);
+        });
+        cout << "[MAIN] Recording captured frames to " << options.recordPath << "\n";
+    }
+    t0 = chrono::high_resolution_clock::now();
+    capture.start();
 
     // Capture first frame
-    cv::Mat frame;
-    if (!grabSafeFrame(cap, frame)) {
+    FrameSlot* first = capture.waitForFrame(2000);
+    startup.firstFrameWaitMs = msSince(t0);
+    if (!first) {
         cerr << "Error: could not capture initial frame\n";
-        cap.release();
+        capture.stop();
+        delete source;
+        textures.clear();
+        shaders.release();
         glfwTerminate();
         return -1;
     }
-    cv::flip(frame, frame, 0);
+    // Frames from the ring are read-only, flips go into a separate buffer
+    cv::Mat flipped, firstBGR;
+    FrameSource::toBGR(first->frame, source->pixelFormat(), firstBGR);
+    cv::flip(firstBGR, flipped, 0);
+    capture.release();
 
     // Create resources
-    Texture* videoTexture = new Texture(frame.data, frame.cols, frame.rows, true);
-
-    TextureShader* defaultShader = new TextureShader("videoTextureShader.vert", "videoTextureShader.frag");
-    TextureShader* pixelateShader = new TextureShader("videoTextureShader.vert", "pixelate.frag");
-    TextureShader* sinCityShader  = new TextureShader("videoTextureShader.vert", "sincity.frag");
+    if (options.tiled || TiledTexture::needsTiling(firstBGR.cols, firstBGR.rows)) {
+        tiledTexture = new TiledTexture(options.tileSize, (size_t)max(1, options.tileBudgetMB) << 20);
+        tiledTexture->setImage(firstBGR);
+        TileStats tiles = tiledTexture->stats();
+        cout << "[MAIN] Tiled streaming: " << firstBGR.cols << "x" << firstBGR.rows << " as " << tiles.tilesX << "x"
+             << tiles.tilesY << " tiles of " << tiledTexture->tileSize() << " px, budget " << options.tileBudgetMB << " MB\n";
+    }
+    // in tiled mode videoTexture is only a placeholder for the programs
+    Texture* videoTexture = tiledTexture ? new Texture(4, 4) : new Texture(flipped.data, flipped.cols, flipped.rows, true);
+    videoTexture->setRingDepth(options.textureRing);
+    if (configureUpload(videoTexture, !options.streamingUpload) == "pbo" && options.persistentUpload)
+        cout << "[MAIN] glBufferStorage not available, uploading through PBOs\n";
+    if (options.bc1) {
+        bc1Upload = Texture::compressedUploadSupported();
+        if (bc1Upload) cout << "[MAIN] BC1 upload on (" << (BC1::simdAvailable() ? "SSE2" : "scalar") << " encoder)\n";
+        else cout << "[MAIN] GL_EXT_texture_compression_s3tc not available, uploading uncompressed\n";
+    }
+    float aspectRatio = (float)flipped.cols / (float)flipped.rows;
 
-    defaultShader->setTexture(videoTexture);
-    pixelateShader->setTexture(videoTexture);
-    sinCityShader->setTexture(videoTexture);
+    shaders.setTexture(videoTexture);
 
     Scene* scene = new Scene();
     Camera* cam = new Camera();
     cam->setPosition(glm::vec3(0,0,-2.5f));
 
-    Quad* quad = new Quad((float)frame.cols / (float)frame.rows);
-    quad->setShader(defaultShader);
+    Quad* quad = new Quad(aspectRatio);
+    setQuadFilter(quad, shaders, FILTER_NONE);
     scene->addObject(quad);
 
+    // Present the first frame right away, that is what time-to-first-frame measures
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    scene->render(cam);
+    glfwSwapBuffers(window);
+    startup.firstFrameMs = msSince(processStart);
+    reportStartup(startup, source->name());
+
     // Interactive FPS logging CSV
     std::ofstream csv("fps_log.csv", ios::app);
-    if (csv.tellp() == 0) csv << "Frame,Backend,Filter,FPS\n";
+    if (csv.tellp() == 0) csv << "Frame,Backend,Filter,FPS,Scheduling,ProcessedFPS,Dropped,Superseded,AvgFrameAgeMs,MatAllocsPerFrame,OsAllocsPerFrame\n";
+
+    if (!options.shmName.empty() && !shmWriter.open(options.shmName, (uint32_t)max(2, options.shmSlots)))
+        cerr << "[MAIN] Shared-memory output " << options.shmName << " not available\n";
+
+    FrameReadback* readback = new FrameReadback(options.readbackDepth);
+    if (!options.recordOutputPath.empty()) outputEncoder.open(options.recordOutputPath, options.source.fps);
+    if (options.httpPort > 0) httpServer.start(options.httpPort, options.httpThreads, options.httpQuality);
+
+    // CPU filtering in latest-frame-wins mode: the worker always filters the newest frame, the
+    // window thread presents the newest result and only does the warp, so transforms stay smooth
+    LatestFrameWorker cpuWorker(capture, [&capture](cv::Mat& frame, cv::Mat& out) {
+        cpuFilter(frame, capture.source().pixelFormat(), activeFilter.load(), out);
+    });
+    DisplayTransform shownTransform;
+    cv::Mat rotated;
 
     int frameCount = 0;
+    double frameAgeMsSum = 0.0;
     auto startTime = chrono::high_resolution_clock::now();
+    CaptureStats intervalCapture = capture.stats();
+    WorkerStats intervalWorker;
+    FramePoolStats intervalPool = FramePool::installed() ? FramePool::installed()->stats() : FramePoolStats();
+    PoolStats intervalThreads = WorkStealingPool::shared().stats();
+
+    // tiled streaming: pan/zoom latency is input poll to swap of the first frame drawn with the new transform
+    DisplayTransform tiledShown;
+    int64_t tiledCaptureNs = 0;
+    double panLatencyMsSum = 0.0, panLatencyMsMax = 0.0;
+    int panLatencySamples = 0;
+    TileStats intervalTiles;
+    std::ofstream tileLog;
+    if (tiledTexture) {
+        tileLog.open("tiles_log.csv", ios::app);
+        if (tileLog.tellp() == 0)
+            tileLog << "tiles_x,tiles_y,tile_size,visible,resident,resident_mb,budget_mb,uploads,evictions,"
+                       "over_budget,avg_pan_zoom_latency_ms,max_pan_zoom_latency_ms\n";
+    }
+
+    if (options.batchOnly) batchRequested = true;
 
     // main loop
     while (!glfwWindowShouldClose(window)) {
+        auto loopStart = chrono::high_resolution_clock::now();
         processInput();
 
         // If user requested a batch and none is running, run it
         if (batchRequested.exchange(false) && !batchRunning.load()) {
+            // the batch consumes frames itself
+            cpuWorker.stop();
             // run batch in-line 
-            runBatchExperiments(cap, videoTexture, quad, scene, cam,
-                                defaultShader, pixelateShader, sinCityShader);
-            // continue;
+            runBatchExperiments(capture, videoTexture, quad, scene, cam,
+                                shaders);
+            if (options.batchOnly) break;
         }
 
-        // Grab safe frame
-        if (!grabSafeFrame(cap, frame)) {
-            // If no valid frame, let events happen and continue
-            glfwPollEvents();
-            std::this_thread::sleep_for(std::chrono::milliseconds(3));
-            continue;
+        const bool asyncCPU = !useGPU && options.asyncProcessing;
+        if (asyncCPU != cpuWorker.isRunning()) {
+            if (asyncCPU) cpuWorker.start();
+            else cpuWorker.stop();
+            intervalWorker = cpuWorker.stats();
+            shownTransform = DisplayTransform();
         }
 
-        if (useGPU) {
-            cv::flip(frame, frame, 0);
-            videoTexture->update(frame.data, frame.cols, frame.rows, true);
-
-           
-            quad->setTranslate(glm::vec3(translateX, translateY, 0.0f));
-            quad->setRotate(rotateAngle);
-            quad->setScale(scaleFactor);
-
-            
-            if (activeFilter == FILTER_PIXELATE) quad->setShader(pixelateShader);
-            else if (activeFilter == FILTER_SINCITY) quad->setShader(sinCityShader);
-            else quad->setShader(defaultShader);
-
-        } else {
-            // CPU path: apply filter then warpAffine transforms
-            cv::Mat processed;
-            if (activeFilter == FILTER_PIXELATE) CPUFilters::pixelate(frame, processed, 10);
-            else if (activeFilter == FILTER_SINCITY) CPUFilters::sinCity(frame, processed);
-            else processed = frame.clone();
-
-            cv::Mat rotated;
-            cv::Point2f center(processed.cols/2.0f, processed.rows/2.0f);
-            cv::Mat M = cv::getRotationMatrix2D(center, rotateAngle, scaleFactor);
-            M.at<double>(0,2) += translateX * processed.cols;
-            M.at<double>(1,2) -= translateY * processed.rows;
-            cv::warpAffine(processed, rotated, M, processed.size());
-            cv::flip(rotated, rotated, 0);
-
-            videoTexture->update(rotated.data, rotated.cols, rotated.rows, true);
-
-            // CPU output uses default shader; show transformed image as-is
-            quad->setShader(defaultShader);
-            // ensure quad identity transform so warped image maps directly
+        int64_t shownCaptureNs = 0;
+        if (asyncCPU) {
+            bool fresh = cpuWorker.fetchLatest();
+            const ProcessedFrame& result = cpuWorker.latest();
+            DisplayTransform transform = currentTransform();
+            if (result.image.empty() || (!fresh && transform == shownTransform)) {
+                // nothing new to show
+                glfwPollEvents();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            uploadProcessed(videoTexture, result.image, transform, rotated, result.captureTimeNs);
+            shownTransform = transform;
+            shownCaptureNs = result.captureTimeNs;
+
+            setQuadFilter(quad, shaders, FILTER_NONE);
             quad->setTranslate(glm::vec3(0.0f,0.0f,0.0f));
             quad->setRotate(0.0f);
             quad->setScale(1.0f);
+
+        } else {
+            // Pick up the newest captured frame, never wait for the camera
+            FrameSlot* slot = capture.acquireLatest();
+            // tiled mode redraws a pan or zoom right away from the frame it already holds
+            const bool tiledRedraw = !slot && useGPU && tiledTexture && !(currentTransform() == tiledShown);
+            if (!slot && !tiledRedraw) {
+                // No new frame yet, let events happen and continue
+                glfwPollEvents();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            if (tiledRedraw) {
+                shownCaptureNs = tiledCaptureNs;
+                quad->setTranslate(glm::vec3(translateX, translateY, 0.0f));
+                quad->setRotate(rotateAngle);
+                quad->setScale(scaleFactor);
+                setQuadFilter(quad, shaders, activeFilter);
+            } else {
+                cv::Mat& frame = slot->frame;
+                const FramePixelFormat pixelFormat = capture.source().pixelFormat();
+                shownCaptureNs = slot->captureTimeNs;
+
+                if (useGPU) {
+                    uploadFrame(videoTexture, frame, pixelFormat, flipped);
+
+                   
+                    quad->setTranslate(glm::vec3(translateX, translateY, 0.0f));
+                    quad->setRotate(rotateAngle);
+                    quad->setScale(scaleFactor);
+
+                    
+                    setQuadFilter(quad, shaders, activeFilter);
+
+                } else {
+                    // CPU path: apply filter then warpAffine transforms, in one pass with --fused-warp
+                    cv::Mat bgr, processed;
+                    FrameSource::toBGR(frame, pixelFormat, bgr);
+                    if (!options.fusedWarp || !uploadFused(videoTexture, bgr, activeFilter, currentTransform(), rotated, shownCaptureNs)) {
+                        if (activeFilter == FILTER_PIXELATE) CPUFilters::pixelate(bgr, processed, 10);
+                        else if (activeFilter == FILTER_SINCITY) CPUFilters::sinCity(bgr, processed);
+                        else processed = bgr;
+
+                        uploadProcessed(videoTexture, processed, currentTransform(), rotated, shownCaptureNs);
+                    }
+
+                    // CPU output uses default shader; show transformed image as-is
+                    setQuadFilter(quad, shaders, FILTER_NONE);
+                    // ensure quad identity transform so warped image maps directly
+                    quad->setTranslate(glm::vec3(0.0f,0.0f,0.0f));
+                    quad->setRotate(0.0f);
+                    quad->setScale(1.0f);
+                }
+                capture.release();
+            }
         }
 
         // Render
+        updateMipLevel(videoTexture, quad, cam);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         scene->render(cam);
+        readback->collect(deliverReadback);
+        if (outputEncoder.isOpen() || httpServer.wantsFrames() || (useGPU && shmWriter.isOpen())) {
+            // must be queued before the swap, the back buffer is undefined afterwards
+            int fbWidth = 0, fbHeight = 0;
+            glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+            readback->queue(fbWidth, fbHeight, shownCaptureNs);
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
 
+        // end-to-end age of what was just presented: capture timestamp to swap
+        frameAgeMsSum += (steadyNowNs() - shownCaptureNs) / 1e6;
+        if (tiledTexture) {
+            DisplayTransform t = currentTransform();
+            if (!(t == tiledShown)) {
+                double latencyMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - loopStart).count();
+                panLatencyMsSum += latencyMs;
+                panLatencyMsMax = std::max(panLatencyMsMax, latencyMs);
+                ++panLatencySamples;
+                tiledShown = t;
+            }
+            tiledCaptureNs = shownCaptureNs;
+        }
+
         // FPS logging
         ++frameCount;
         auto now = chrono::high_resolution_clock::now();
         double elapsed = chrono::duration<double>(now - startTime).count();
         if (elapsed >= 1.0) {
             double fps = frameCount / elapsed;
-            csv << frameCount << "," << (useGPU ? "GPU" : "CPU") << "," << activeFilter << "," << fps << "\n";
+            double avgAgeMs = frameAgeMsSum / frameCount;
+            CaptureStats captureNow = capture.stats();
+            CaptureStats captureDelta = captureNow - intervalCapture;
+            WorkerStats workerNow = cpuWorker.stats();
+            uint64_t processed = asyncCPU ? workerNow.processed - intervalWorker.processed : (uint64_t)frameCount;
+            uint64_t superseded = asyncCPU ? workerNow.superseded - intervalWorker.superseded : 0;
+            double processedFps = processed / elapsed;
+            // Mat buffers per displayed frame, from the pool and new from the OS (0 once warmed up)
+            FramePoolStats poolNow = FramePool::installed() ? FramePool::installed()->stats() : FramePoolStats();
+            FramePoolStats poolDelta = poolNow - intervalPool;
+            double matAllocs = double(poolDelta.allocations) / frameCount;
+            double osAllocs = double(poolDelta.systemAllocations) / frameCount;
+
+            csv << frameCount << "," << (useGPU ? "GPU" : "CPU") << "," << (int)activeFilter.load() << "," << fps << ","
+                << (asyncCPU ? "latest" : "sync") << "," << processedFps << ","
+                << captureDelta.dropped << "," << superseded << "," << avgAgeMs << ",";
+            if (FramePool::installed()) csv << matAllocs << "," << osAllocs;
+            csv << "\n";
             frameCount = 0;
+            frameAgeMsSum = 0.0;
             startTime = now;
+            intervalCapture = captureNow;
+            intervalWorker = workerNow;
+            intervalPool = poolNow;
+            PoolStats threadsNow = WorkStealingPool::shared().stats();
+            PoolStats threadsDelta = threadsNow - intervalThreads;
+            intervalThreads = threadsNow;
             // also print to console for convenience
             cout << "[MAIN] FPS: " << fixed << setprecision(2) << fps
                  << " | Mode: " << (useGPU ? "GPU" : "CPU")
-                 << " | Filter: " << (activeFilter==FILTER_NONE ? "NONE" : (activeFilter==FILTER_PIXELATE ? "PIXELATE" : "SINCITY"))
-                 << "\n";
+                 << " | Filter: " << filterName(activeFilter)
+                 << " | Processed: " << processedFps
+                 << " | Dropped: " << captureDelta.dropped
+                 << " | Age: " << avgAgeMs << " ms";
+            if (FramePool::installed())
+                cout << " | Allocs: " << setprecision(1) << matAllocs << "/frame, " << osAllocs << " new";
+            if (!useGPU)
+                cout << " | Pool: " << WorkStealingPool::shared().activeThreads() << " threads, "
+                     << setprecision(0) << threadsDelta.averageUtilization() * 100.0 << "% busy";
+            if (capture.decoder())
+                cout << " | Decode: " << setprecision(2) << capture.decoder()->averageDecodeMs() << " ms";
+            if (shmWriter.isOpen()) {
+                SharedReaderLag lag[kShmMaxReaders];
+                int readers = shmWriter.readerLag(lag, kShmMaxReaders);
+                uint64_t maxBehind = 0;
+                for (int r = 0; r < readers; ++r) maxBehind = std::max(maxBehind, lag[r].behind);
+                cout << " | Shm: " << readers << " readers, max " << maxBehind << " behind";
+            }
+            if (outputEncoder.isOpen()) {
+                ReadbackStats rb = readback->stats();
+                EncoderStats enc = outputEncoder.stats();
+                cout << " | Rec: " << enc.encoded << " frames, " << enc.dropped + rb.skipped << " dropped";
+            }
+            if (httpServer.isRunning()) {
+                MjpegStats http = httpServer.stats();
+                cout << " | HTTP: " << http.clients.size() << " viewers, encode " << http.avgEncodeMs
+                     << " ms, queue " << http.queueDepth << "/" << http.maxInFlight;
+                for (const MjpegClientStats& c : http.clients) cout << " [" << c.address << " " << c.fps << " fps]";
+            }
+            if (tiledTexture) {
+                TileStats tiles = tiledTexture->stats();
+                double residentMb = tiles.residentBytes / 1048576.0, budgetMb = tiles.budgetBytes / 1048576.0;
+                double avgLatencyMs = panLatencySamples ? panLatencyMsSum / panLatencySamples : 0.0;
+                uint64_t uploads = tiles.uploads - intervalTiles.uploads;
+                uint64_t evictions = tiles.evictions - intervalTiles.evictions;
+                cout << " | Tiles: " << tiles.visible << " visible, " << tiles.resident << " resident ("
+                     << setprecision(0) << residentMb << "/" << budgetMb << " MB), " << uploads << " uploads"
+                     << setprecision(2) << ", pan/zoom " << avgLatencyMs << " ms";
+                tileLog << tiles.tilesX << "," << tiles.tilesY << "," << tiledTexture->tileSize() << ","
+                        << tiles.visible << "," << tiles.resident << "," << residentMb << "," << budgetMb << ","
+                        << uploads << "," << evictions << "," << tiles.overBudget - intervalTiles.overBudget << ","
+                        << avgLatencyMs << "," << panLatencyMsMax << "\n";
+                intervalTiles = tiles;
+                panLatencyMsSum = panLatencyMsMax = 0.0;
+                panLatencySamples = 0;
+            }
+            cout << "\n";
         }
     }
 
+    cpuWorker.stop();
+    readback->collect(deliverReadback, true);
+    delete readback;
+    outputEncoder.close();
+    httpServer.stop();
+    shmWriter.close();
+
     // cleanup
-    cap.release();
+    capture.stop();
+    recorder.close();
+    delete source;
 
     delete videoTexture;
+    delete tiledTexture;
     delete quad;
     delete cam;
     delete scene;
-    delete defaultShader;
-    delete pixelateShader;
-    delete sinCityShader;
+    textures.clear();
+    shaders.release();
 
     glfwTerminate();
     csv.close();